@@ -0,0 +1,7 @@
+struct Camera {
+    projection: mat4x4<f32>,
+    view: mat4x4<f32>,
+}
+
+@group(0) @binding(1)
+var<uniform> camera: Camera;
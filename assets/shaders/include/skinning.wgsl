@@ -0,0 +1,22 @@
+#ifdef COMPACT_VERTICES
+#define PALETTE_BINDING 3
+#else
+#define PALETTE_BINDING 2
+#endif
+
+struct Model {
+    transform: mat4x4<f32>,
+    jointOffset: u32,
+}
+
+@group(1) @binding(1)
+var<uniform> model: Model;
+@group(1) @binding(PALETTE_BINDING)
+var<storage, read> palette: array<mat4x4<f32>>;
+
+fn skinMatrix(joints: vec4<u32>, weights: vec4<f32>) -> mat4x4<f32> {
+    return palette[model.jointOffset + joints.x] * weights.x +
+           palette[model.jointOffset + joints.y] * weights.y +
+           palette[model.jointOffset + joints.z] * weights.z +
+           palette[model.jointOffset + joints.w] * weights.w;
+}
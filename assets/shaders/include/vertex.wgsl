@@ -0,0 +1,58 @@
+#ifdef COMPACT_VERTICES
+#define POSITION_TYPE vec4<f32>
+#define NORMAL_TYPE vec2<f32>
+#else
+#define POSITION_TYPE vec3<f32>
+#define NORMAL_TYPE vec3<f32>
+#endif
+
+struct VertexIn {
+    @location(0) position: POSITION_TYPE,
+    @location(1) normal: NORMAL_TYPE,
+    @location(2) uv: vec2<f32>,
+}
+
+struct SkinnedVertexIn {
+    @location(0) position: POSITION_TYPE,
+    @location(1) normal: NORMAL_TYPE,
+    @location(2) uv: vec2<f32>,
+    @location(3) joints: vec4<u32>,
+    @location(4) weights: vec4<f32>,
+}
+
+struct VertexOut {
+    @builtin(position) position: vec4<f32>,
+    @location(0) normal: vec3<f32>,
+    @location(1) uv: vec2<f32>,
+    @location(2) tint: vec4<f32>,
+}
+
+#ifdef COMPACT_VERTICES
+struct Bounds {
+    origin: vec4<f32>,
+    extent: vec4<f32>,
+}
+
+@group(1) @binding(2)
+var<uniform> bounds: Bounds;
+
+fn decodePosition(position: POSITION_TYPE) -> vec3<f32> {
+    return bounds.origin.xyz + position.xyz * bounds.extent.xyz;
+}
+
+fn decodeNormal(e: NORMAL_TYPE) -> vec3<f32> {
+    var n = vec3<f32>(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    let t = max(-n.z, 0.0);
+    n.x += select(t, -t, n.x >= 0.0);
+    n.y += select(t, -t, n.y >= 0.0);
+    return normalize(n);
+}
+#else
+fn decodePosition(position: POSITION_TYPE) -> vec3<f32> {
+    return position;
+}
+
+fn decodeNormal(normal: NORMAL_TYPE) -> vec3<f32> {
+    return normal;
+}
+#endif
@@ -1,37 +1,71 @@
-struct VertexIn {
-    @location(0) position: vec3<f32>,
-    @location(1) normal: vec3<f32>,
-    @location(2) uv: vec2<f32>,
+#include "include/camera.wgsl"
+#include "include/vertex.wgsl"
+#include "include/skinning.wgsl"
+
+struct InstanceIn {
+    @location(5) transform0: vec4<f32>,
+    @location(6) transform1: vec4<f32>,
+    @location(7) transform2: vec4<f32>,
+    @location(8) transform3: vec4<f32>,
+    @location(9) tint: vec4<f32>,
 }
 
-struct VertexOut {
-    @builtin(position) position: vec4<f32>,
-    @location(0) normal: vec3<f32>,
-    @location(1) uv: vec2<f32>,
+@vertex
+fn vs_main(in: VertexIn) -> VertexOut {
+    var out: VertexOut;
+    out.position = camera.projection * camera.view * model.transform * vec4<f32>(decodePosition(in.position), 1.0);
+    out.normal = decodeNormal(in.normal);
+    out.uv = in.uv;
+    out.tint = vec4<f32>(1.0);
+    return out;
+}
+
+@vertex
+fn vs_skinned(in: SkinnedVertexIn) -> VertexOut {
+    let skin = skinMatrix(in.joints, in.weights);
+
+    var out: VertexOut;
+    out.position = camera.projection * camera.view * model.transform * skin * vec4<f32>(decodePosition(in.position), 1.0);
+    out.normal = normalize((skin * vec4<f32>(decodeNormal(in.normal), 0.0)).xyz);
+    out.uv = in.uv;
+    out.tint = vec4<f32>(1.0);
+    return out;
 }
 
-struct Camera {
-    projection: mat4x4<f32>,
-    view: mat4x4<f32>,
+fn instanceMatrix(instance: InstanceIn) -> mat4x4<f32> {
+    return mat4x4<f32>(instance.transform0, instance.transform1, instance.transform2, instance.transform3);
 }
 
-@group(0) @binding(1)
-var<uniform> camera: Camera;
-@group(1) @binding(1)
-var<uniform> model: mat4x4<f32>;
+@vertex
+fn vs_instanced(in: VertexIn, instance: InstanceIn) -> VertexOut {
+    let transform = instanceMatrix(instance);
+    let position = decodePosition(in.position);
+
+    var out: VertexOut;
+    out.position = camera.projection * camera.view * model.transform * transform * vec4<f32>(position, 1.0);
+    out.normal = normalize((transform * vec4<f32>(decodeNormal(in.normal), 0.0)).xyz);
+    out.uv = in.uv;
+    out.tint = instance.tint;
+    return out;
+}
 
 @vertex
-fn vs_main(in: VertexIn) -> VertexOut {
+fn vs_skinned_instanced(in: SkinnedVertexIn, instance: InstanceIn) -> VertexOut {
+    let transform = instanceMatrix(instance) * skinMatrix(in.joints, in.weights);
+    let position = decodePosition(in.position);
+
     var out: VertexOut;
-    out.position = camera.projection * camera.view * model * vec4<f32>(in.position, 1.0);
-    out.normal = in.normal;
+    out.position = camera.projection * camera.view * model.transform * transform * vec4<f32>(position, 1.0);
+    out.normal = normalize((transform * vec4<f32>(decodeNormal(in.normal), 0.0)).xyz);
     out.uv = in.uv;
+    out.tint = instance.tint;
     return out;
 }
 
 struct FragmentIn {
     @location(0) normal: vec3<f32>,
     @location(1) uv: vec2<f32>,
+    @location(2) tint: vec4<f32>,
 }
 
 @group(0) @binding(0)
@@ -41,5 +75,5 @@ var texture: texture_2d<f32>;
 
 @fragment
 fn fs_main(in: FragmentIn) -> @location(0) vec4<f32> {
-    return textureSample(texture, sampler2d, in.uv);
-}
\ No newline at end of file
+    return textureSample(texture, sampler2d, in.uv) * in.tint;
+}
@@ -0,0 +1,198 @@
+#include <iostream>
+#include <fstream>
+#include <string_view>
+#include <algorithm>
+#include <numbers>
+#include <cmath>
+
+#include <WEngine.hpp>
+
+struct WBenchOptions {
+    std::vector<std::string> models;
+    std::string path = "orbit";
+    std::string output;
+    uint32_t frames = 300;
+    uint32_t warmupFrames = 30;
+};
+
+static double percentile(std::vector<double> sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+static std::string escapeJson(std::string_view text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+static std::function<void(uint32_t, WCameraManager &)> cameraPath(const std::string &name, uint32_t frames) {
+    const glm::vec3 center{0.0f, 4.0f, 0.0f};
+    if (name == "away") {
+        return [center, frames](uint32_t frame, WCameraManager &camera) {
+            float angle = 2.0f * std::numbers::pi_v<float> * frame / frames;
+            glm::vec3 position = center + glm::vec3(std::cos(angle) * 15.0f, 2.0f, std::sin(angle) * 15.0f);
+            camera.lookAt(position, position + (position - center));
+        };
+    }
+    if (name == "zoomout") {
+        return [center, frames](uint32_t frame, WCameraManager &camera) {
+            float distance = 5.0f * std::pow(100.0f, std::min(1.0f, (float)frame / frames));
+            camera.lookAt(center + glm::vec3(0.0f, distance * 0.25f, -distance), center);
+        };
+    }
+    if (name != "orbit") {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Unknown camera path: '{}'", name).c_str());
+    }
+    return [center, frames](uint32_t frame, WCameraManager &camera) {
+        float angle = 2.0f * std::numbers::pi_v<float> * frame / frames;
+        camera.lookAt(center + glm::vec3(std::cos(angle) * 15.0f, 2.0f, std::sin(angle) * 15.0f), center);
+    };
+}
+
+static std::string report(const WBenchOptions &options, const WEngineConfig &config, const WEngineRunStats &stats) {
+    std::vector<double> measured(stats.frameMilliseconds.begin() +
+                                     std::min<size_t>(options.warmupFrames, stats.frameMilliseconds.size()),
+                                 stats.frameMilliseconds.end());
+    double total = 0.0;
+    for (double milliseconds : measured) {
+        total += milliseconds;
+    }
+    double average = measured.empty() ? 0.0 : total / measured.size();
+    double frames = std::max(1u, stats.frames);
+
+    WTextureStreamingStats streaming = WTextureCache::GetStats();
+
+    std::string models;
+    for (const std::string &model : options.models) {
+        models += fmt::format("{}\"{}\"", models.empty() ? "" : ", ", escapeJson(model));
+    }
+
+    return fmt::format(
+        "{{\n"
+        "  \"models\": [{}],\n"
+        "  \"cameraPath\": \"{}\",\n"
+        "  \"width\": {},\n"
+        "  \"height\": {},\n"
+        "  \"headless\": {},\n"
+        "  \"framesInFlight\": {},\n"
+        "  \"instanceGrid\": {},\n"
+        "  \"compactVertices\": {},\n"
+        "  \"warmupFrames\": {},\n"
+        "  \"frames\": {},\n"
+        "  \"loadMs\": {:.3f},\n"
+        "  \"firstFrameMs\": {:.3f},\n"
+        "  \"frameMs\": {{\"avg\": {:.3f}, \"p50\": {:.3f}, \"p95\": {:.3f}, \"p99\": {:.3f}, \"max\": {:.3f}}},\n"
+        "  \"framesPerSecond\": {:.2f},\n"
+        "  \"framesPerCpuSecond\": {:.2f},\n"
+        "  \"drawsPerFrame\": {:.2f},\n"
+        "  \"culledPerFrame\": {:.2f},\n"
+        "  \"instancesPerFrame\": {:.2f},\n"
+        "  \"pipelineCache\": {{\"hits\": {}, \"misses\": {}}},\n"
+        "  \"layoutCache\": {{\"bindGroupLayoutHits\": {}, \"pipelineLayoutHits\": {}, \"samplerHits\": {}}},\n"
+        "  \"gpuMemoryMiB\": {{\"current\": {:.2f}, \"peak\": {:.2f}}},\n"
+        "  \"textureStreaming\": {{\"residentMiB\": {:.2f}, \"budgetMiB\": {:.2f}, \"textures\": {}, \"uploads\": {}, \"evictions\": {}}}\n"
+        "}}\n",
+        models, escapeJson(options.path), config.width, config.height, config.headless, config.framesInFlight,
+        config.instanceGrid, config.compactVertices, options.warmupFrames, measured.size(), stats.loadMilliseconds,
+        stats.firstFrameMilliseconds, average, percentile(measured, 50.0), percentile(measured, 95.0),
+        percentile(measured, 99.0), measured.empty() ? 0.0 : *std::max_element(measured.begin(), measured.end()),
+        stats.framesPerSecond(), stats.framesPerCpuSecond(), stats.draws / frames, stats.culled / frames,
+        stats.instances / frames, WPipelineCache::GetStats().hits, WPipelineCache::GetStats().misses,
+        WPipelineCache::GetBindGroupLayoutStats().hits, WPipelineCache::GetPipelineLayoutStats().hits,
+        WPipelineCache::GetSamplerStats().hits, stats.memory.bytes / 1048576.0,
+        stats.memory.peakBytes / 1048576.0, streaming.residentBytes / 1048576.0,
+        streaming.budget / 1048576.0, streaming.textures, streaming.uploads, streaming.evictions);
+}
+
+int main(int argc, char **argv) {
+    WBenchOptions options{};
+    WEngineConfig config{
+        .title = "LearnWGPU Bench",
+        .width = 1280,
+        .height = 720,
+        .headless = true,
+        .fixedTimestep = 1.0f / 60.0f,
+    };
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::exception(fmt::format("[WEngine]::[ERROR]: Missing value for '{}'", arg).c_str());
+                }
+                return argv[++i];
+            };
+            if (arg == "--model") {
+                options.models.push_back(value());
+            } else if (arg == "--path") {
+                options.path = value();
+            } else if (arg == "--frames") {
+                options.frames = std::stoul(value());
+            } else if (arg == "--warmup") {
+                options.warmupFrames = std::stoul(value());
+            } else if (arg == "--output") {
+                options.output = value();
+            } else if (arg == "--width") {
+                config.width = std::stoul(value());
+            } else if (arg == "--height") {
+                config.height = std::stoul(value());
+            } else if (arg == "--frames-in-flight") {
+                config.framesInFlight = std::stoul(value());
+            } else if (arg == "--texture-budget") {
+                config.textureBudget = std::stoull(value()) * 1048576;
+            } else if (arg == "--instance-grid") {
+                config.instanceGrid = std::stoi(value());
+            } else if (arg == "--compact-vertices") {
+                config.compactVertices = true;
+            } else if (arg == "--windowed") {
+                config.headless = false;
+            } else if (arg == "--fallback-adapter") {
+                config.forceFallbackAdapter = true;
+            } else {
+                throw std::exception(fmt::format("[WEngine]::[ERROR]: Unknown argument: '{}'", arg).c_str());
+            }
+        }
+        if (options.models.empty()) {
+            options.models = {"assets/models/vanguard/flair.fbx", "assets/models/bob/model.dae"};
+        }
+        config.models = options.models;
+        config.instanced = config.instanceGrid > 1;
+        config.maxFrames = options.warmupFrames + options.frames;
+        config.cameraPath = cameraPath(options.path, config.maxFrames);
+
+        WEngine::Initialize(config);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    WEngine &engine = WEngine::GetInstance();
+    int result = 0;
+    try {
+        engine.run();
+        std::string json = report(options, config, engine.getRunStats());
+        if (options.output.empty()) {
+            std::cout << json;
+        } else {
+            std::ofstream(options.output) << json;
+            fmt::println("[WEngine]::[INFO]: Wrote benchmark results to '{}'", options.output);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        result = 1;
+    }
+
+    WEngine::Shutdown();
+    return result;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <WInclude.hpp>
+#include <WResource.hpp>
+
+#include <optional>
+
+#include <glm/gtc/quaternion.hpp>
+
+struct WModelSkin {
+    uint16_t joints[4];
+    uint8_t weights[4];
+
+    static WVertexLayout Append(WVertexLayout layout, size_t stride, size_t offset);
+};
+
+struct WSkeletonNode {
+    int32_t parent;
+    glm::mat4 transform;
+};
+
+struct WSkeletonJoint {
+    uint32_t node;
+    glm::mat4 offset;
+};
+
+struct WVectorKey {
+    float time;
+    glm::vec3 value;
+};
+
+struct WQuatKey {
+    float time;
+    glm::quat value;
+};
+
+struct WAnimationChannel {
+    uint32_t node;
+    std::vector<WVectorKey> positions;
+    std::vector<WQuatKey> rotations;
+    std::vector<WVectorKey> scales;
+};
+
+struct WAnimationClip {
+    std::string name;
+    float duration;
+    float ticksPerSecond;
+    std::vector<WAnimationChannel> channels;
+};
+
+class WSkeleton {
+   public:
+    std::vector<WSkeletonNode> nodes;
+    std::vector<WSkeletonJoint> joints;
+    std::vector<WAnimationClip> clips;
+    glm::mat4 globalInverse{1.0f};
+
+    void sample(uint32_t clip, float seconds, std::span<glm::mat4> palette) const;
+
+    std::vector<unsigned char> serialize() const;
+    static std::optional<WSkeleton> Deserialize(std::span<const unsigned char> bytes);
+
+   private:
+    mutable std::vector<glm::mat4> globals;
+};
+
+class WJointPalette {
+   public:
+    static WJointPalette New(WGPUDevice device, uint32_t capacity);
+
+    uint32_t allocate(uint32_t count);
+    std::span<glm::mat4> getJoints(uint32_t offset, uint32_t count);
+    void upload(WGPUQueue queue);
+
+    inline WGPUBuffer getBuffer() const { return buffer.get(); }
+    inline size_t getSize() const { return joints.size() * sizeof(glm::mat4); }
+
+   private:
+    WOwned<WGPUBuffer> buffer;
+    std::vector<glm::mat4> joints;
+    uint32_t used = 0;
+};
@@ -23,6 +23,17 @@ const float ZOOM = 45.0f;
 
 const glm::vec3 WORLD_UP = glm::vec3(0.0f, 1.0f, 0.0f);
 
+class WFrustum {
+   public:
+    static WFrustum FromMatrix(const glm::mat4 &viewProjection);
+
+    bool intersectsSphere(glm::vec3 center, float radius) const;
+    bool intersectsBox(glm::vec3 center, glm::vec3 extent) const;
+
+   private:
+    glm::vec4 m_Planes[6];
+};
+
 class WCamera {
    public:
     WCamera();
@@ -31,6 +42,8 @@ class WCamera {
     WCamera &withPosition(glm::vec3 position);
     WCamera &withFront(glm::vec3 front);
 
+    void lookAt(glm::vec3 position, glm::vec3 target);
+
     void processCameraMovement(WCameraMovement direction, float dt);
     void processMouseMovement(float xOffset, float yOffset, bool constrain = true, float constrainValue = 89.9f);
     void processMouseScroll(float yOffset, float zoomMax = 45.0f, float zoomMin = 1.0f);
@@ -80,6 +93,7 @@ class WCameraManager {
     void processCameraMovement(WCameraMovement direction, float dt);
     void processMouseMovement(float xPos, float yPos, bool constrain = true, float constrainValue = 89.9f);
     void processMouseScroll(float yOffset, float zoomMax = 45.0f, float zoomMin = 1.0f);
+    void lookAt(glm::vec3 position, glm::vec3 target);
 
     void setWorldUp(glm::vec3 worldUp);
     void setMovementSpeed(float speed);
@@ -95,6 +109,7 @@ class WCameraManager {
 
     glm::mat4 getProjectionMatrix(float aspect) const;
     glm::mat4 getViewMatrix() const;
+    WFrustum getFrustum(float aspect) const;
 
    private:
     WCamera m_Camera;
@@ -2,57 +2,118 @@
 
 #include <WInclude.hpp>
 #include <WCamera.hpp>
+#include <WModel.hpp>
+#include <WFrameSync.hpp>
+#include <WGpuProfiler.hpp>
+#include <WShaderLibrary.hpp>
+#include <WResource.hpp>
+#include <WMemoryTracker.hpp>
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_wgpu.hpp>
 
+struct WEngineConfig {
+    std::string title = "LearnWGPU";
+    uint32_t width = 1200;
+    uint32_t height = 1000;
+    uint32_t framesInFlight = 2;
+    bool headless = false;
+    bool forceFallbackAdapter = false;
+    uint32_t maxFrames = 0;
+    std::vector<std::string> models = {"assets/models/vanguard/punching.dae"};
+    bool instanced = true;
+    int32_t instanceGrid = 1;
+    bool compactVertices = false;
+    float fixedTimestep = 0.0f;
+    uint64_t memoryBudget = 0;
+    bool textureStreaming = true;
+    uint64_t textureBudget = 0;
+    WMemoryBudgetCallback onMemoryBudgetExceeded;
+    std::function<void(uint32_t, WCameraManager &)> cameraPath;
+};
+
+struct WEngineRunStats {
+    uint32_t frames = 0;
+    double wallSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    double loadMilliseconds = 0.0;
+    double firstFrameMilliseconds = 0.0;
+    std::vector<double> frameMilliseconds;
+    uint64_t draws = 0;
+    uint64_t culled = 0;
+    uint64_t instances = 0;
+    WMemoryStats memory;
+
+    inline double framesPerSecond() const { return wallSeconds > 0.0 ? frames / wallSeconds : 0.0; }
+    inline double framesPerCpuSecond() const { return cpuSeconds > 0.0 ? frames / cpuSeconds : 0.0; }
+};
+
 class WEngine {
    public:
     WEngine(const WEngine &) = delete;
     WEngine &operator=(const WEngine &) = delete;
 
-    static void Initialize();
+    static void Initialize(WEngineConfig engineConfig = WEngineConfig{});
     static void Shutdown();
 
     static WEngine &GetInstance();
 
     void run();
+    std::vector<unsigned char> readFrame();
+
+    inline bool isHeadless() const { return engineConfig.headless; }
+    inline const WEngineRunStats &getRunStats() const { return runStats; }
 
    private:
     static WEngine *engine;
 
-    std::string title = "LearnWGPU";
-    uint32_t width = 1200;
-    uint32_t height = 1000;
-    GLFWwindow *window;
+    WEngineConfig engineConfig;
+    std::string title;
+    uint32_t width;
+    uint32_t height;
+    GLFWwindow *window = nullptr;
 
     WGPUInstance instance;
-    WGPUSurface surface;
+    WGPUSurface surface = nullptr;
     WGPUAdapter adapter;
     WGPUDevice device;
     WGPUQueue queue;
     WGPUSurfaceConfiguration config;
     WGPULimits limits;
-    WTexture depthTexture;
+    WOwned<WTexture> depthTexture;
+    WOwned<WTexture> offscreenTexture;
+    WDeletionQueue deletionQueue;
 
     WCameraManager camera{600, 500};
 
     glm::mat4 modelData{1.0f};
     float scale = 1.0f / 20.f;
+    WModelCullStats cullStats;
+    int32_t instanceGrid = 1;
+    int32_t builtInstanceGrid = 1;
+    float instanceSpacing = 100.0f;
+    float builtInstanceSpacing = 100.0f;
 
     float dt;
+    double cpuWait = 0.0;
+    WEngineRunStats runStats;
 
-    WEngine();
+    WEngine(WEngineConfig engineConfig);
     ~WEngine();
 
     void initImGui();
     void shutdownImGui();
-    void updateImGui(WGPURenderPassEncoder encoder);
+    void updateImGui(WGPURenderPassEncoder encoder, const WGpuProfiler &profiler);
 
+    bool shouldClose() const;
+    void resizeDepthTexture(uint32_t width, uint32_t height);
     void presentFrame(std::function<void(WGPUTextureView)> frame);
     void setupLogging(WGPULogLevel level = WGPULogLevel_Warn) const;
     void printWGPUReport() const;
+    void printCacheReport() const;
+    void checkLeaks() const;
+    WGPUHubReport generateHubReport() const;
 
     static void glfwKeyCallback(GLFWwindow *window, int32_t key, int32_t scancode, int32_t action, int32_t mods);
     static void glfwFramebuffersizeCallback(GLFWwindow *window, int32_t width, int32_t height);
@@ -60,6 +121,4 @@ class WEngine {
     static void glfwScrollCallabck(GLFWwindow *window, double x, double y);
 
     static void wgpuLogCallback(WGPULogLevel level, const char *message, void *userdata);
-
-    static WGPUShaderModule shaderFromWgslFile(WGPUDevice device, std::string path);
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <WInclude.hpp>
+
+class WFrameSync {
+   public:
+    static WFrameSync New(WGPUDevice device, WGPUQueue queue, uint32_t framesInFlight);
+
+    WFrameSync() = default;
+    WFrameSync(const WFrameSync &) = delete;
+    WFrameSync &operator=(const WFrameSync &) = delete;
+    WFrameSync(WFrameSync &&) = default;
+    WFrameSync &operator=(WFrameSync &&) = default;
+    ~WFrameSync();
+
+    double beginFrame();
+    void endFrame(WGPUSubmissionIndex submission);
+    void waitIdle();
+
+    inline uint32_t getFrameIndex() const { return frame % framesInFlight; }
+    inline uint32_t getFramesInFlight() const { return framesInFlight; }
+    inline double getWaitMilliseconds() const { return waitMilliseconds; }
+
+   private:
+    struct Slot {
+        WGPUSubmissionIndex submission = 0;
+        bool pending = false;
+    };
+
+    WGPUDevice device = nullptr;
+    WGPUQueue queue = nullptr;
+    std::vector<std::unique_ptr<Slot>> slots;
+    uint32_t framesInFlight = 1;
+    uint64_t frame = 0;
+    double waitMilliseconds = 0.0;
+
+    void wait(Slot &slot);
+};
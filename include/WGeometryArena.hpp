@@ -0,0 +1,72 @@
+#pragma once
+
+#include <WInclude.hpp>
+#include <WResource.hpp>
+
+#include <optional>
+
+class WFreeList {
+   public:
+    static WFreeList New(uint64_t capacity);
+
+    std::optional<uint64_t> allocate(uint64_t size, uint64_t alignment = 1);
+    void free(uint64_t offset, uint64_t size);
+
+    inline uint64_t getCapacity() const { return capacity; }
+    inline uint64_t getUsed() const { return used; }
+    inline uint32_t getFreeBlockCount() const { return blocks.size(); }
+    uint64_t getLargestFreeBlock() const;
+
+   private:
+    std::map<uint64_t, uint64_t> blocks;
+    uint64_t capacity = 0;
+    uint64_t used = 0;
+};
+
+struct WGeometryArenaStats {
+    uint32_t pageCount;
+    uint32_t allocationCount;
+    uint64_t vertexCapacity;
+    uint64_t vertexUsed;
+    uint64_t indexCapacity;
+    uint64_t indexUsed;
+    uint32_t freeBlockCount;
+    float vertexFragmentation;
+    float indexFragmentation;
+};
+
+class WGeometryArena {
+   public:
+    static WGeometryArena New(uint64_t vertexPageSize = 32ull << 20, uint64_t indexPageSize = 16ull << 20);
+
+    template <typename Vertex>
+    WRenderBuffer allocate(WGPUDevice device, std::span<const Vertex> vertices, std::span<const uint32_t> indices) {
+        return allocate(device, vertices.data(), vertices.size(), sizeof(Vertex), indices.data(), indices.size());
+    }
+    WRenderBuffer allocate(WGPUDevice device,
+                           const void *vertices,
+                           size_t verticesCount,
+                           uint32_t vertexStride,
+                           const uint32_t *indices,
+                           size_t indicesCount);
+    void free(const WRenderBuffer &renderBuffer);
+
+    WGeometryArenaStats getStats() const;
+    void printStats() const;
+
+   private:
+    struct Page {
+        uint32_t vertexStride;
+        WOwned<WGPUBuffer> vertex;
+        WOwned<WGPUBuffer> index;
+        WFreeList vertexFree;
+        WFreeList indexFree;
+    };
+
+    std::vector<Page> pages;
+    uint64_t vertexPageSize;
+    uint64_t indexPageSize;
+    uint32_t allocationCount = 0;
+
+    Page &addPage(WGPUDevice device, uint32_t vertexStride, uint64_t vertexCount, uint64_t indexBytes);
+};
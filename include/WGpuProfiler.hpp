@@ -0,0 +1,69 @@
+#pragma once
+
+#include <WInclude.hpp>
+
+struct WGpuTiming {
+    static constexpr uint32_t WINDOW = 64;
+
+    double samples[WINDOW] = {};
+    uint32_t count = 0;
+    uint32_t next = 0;
+    double last = 0.0;
+
+    void add(double milliseconds);
+    double average() const;
+};
+
+class WGpuProfiler {
+   public:
+    static WGpuProfiler New(WGPUDevice device, uint32_t maxScopes = 16, uint32_t latency = 3);
+
+    WGpuProfiler() = default;
+    WGpuProfiler(const WGpuProfiler &) = delete;
+    WGpuProfiler &operator=(const WGpuProfiler &) = delete;
+    WGpuProfiler(WGpuProfiler &&other) noexcept;
+    WGpuProfiler &operator=(WGpuProfiler &&other) noexcept;
+    ~WGpuProfiler();
+
+    inline bool isSupported() const { return querySet != nullptr; }
+
+    void beginFrame(WGPUDevice device);
+    const WGPURenderPassTimestampWrites *passTimestamps(const std::string &name);
+    void resolve(WGPUCommandEncoder encoder);
+    void endFrame();
+
+    void setTimestampPeriod(double nanosecondsPerTick);
+
+    double getAverage(const std::string &name) const;
+    inline const std::map<std::string, WGpuTiming> &getTimings() const { return timings; }
+
+   private:
+    enum class SlotState {
+        Idle,
+        Recording,
+        Resolved,
+        Mapping,
+        Ready,
+    };
+
+    struct Slot {
+        WGPUBuffer readback;
+        std::vector<std::string> names;
+        uint32_t queryCount = 0;
+        SlotState state = SlotState::Idle;
+    };
+
+    WGPUDevice device = nullptr;
+    WGPUQuerySet querySet = nullptr;
+    WGPUBuffer resolveBuffer = nullptr;
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::vector<WGPURenderPassTimestampWrites> passWrites;
+    std::map<std::string, WGpuTiming> timings;
+    uint32_t maxScopes = 0;
+    uint64_t frame = 0;
+    Slot *current = nullptr;
+    double timestampPeriod = 1.0;
+
+    uint32_t allocateScope(const std::string &name);
+    void collect(Slot &slot);
+};
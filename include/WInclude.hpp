@@ -2,6 +2,7 @@
 
 #include <map>
 #include <vector>
+#include <span>
 #include <string>
 #include <functional>
 #include <memory>
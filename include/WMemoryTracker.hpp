@@ -0,0 +1,86 @@
+#pragma once
+
+#include <WInclude.hpp>
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
+enum class WMemoryCategory : uint32_t {
+    Texture,
+    Attachment,
+    Vertex,
+    Index,
+    Uniform,
+    Storage,
+    Staging,
+    Other,
+    Count,
+};
+
+struct WMemoryStats {
+    uint64_t bytes = 0;
+    uint64_t peakBytes = 0;
+    uint32_t allocations = 0;
+};
+
+struct WMemoryBudgetEvent {
+    uint64_t totalBytes;
+    uint64_t budgetBytes;
+    WMemoryCategory category;
+    std::string owner;
+};
+
+using WMemoryBudgetCallback = std::function<void(const WMemoryBudgetEvent &)>;
+
+class WMemoryTracker {
+   public:
+    static void TrackBuffer(WGPUBuffer buffer, const WGPUBufferDescriptor &desc, const std::string &owner = "");
+    static void TrackTexture(WGPUTexture texture, const WGPUTextureDescriptor &desc, const std::string &owner = "");
+    static void Track(const void *handle, WMemoryCategory category, uint64_t bytes, const std::string &owner = "");
+    static void Untrack(const void *handle);
+
+    static void SetBudget(uint64_t bytes, WMemoryBudgetCallback callback);
+    static inline uint64_t GetBudget() { return budget; }
+
+    static WMemoryStats GetTotal();
+    static WMemoryStats GetCategory(WMemoryCategory category);
+    static std::vector<std::pair<std::string, uint64_t>> GetOwners();
+
+    static const char *CategoryName(WMemoryCategory category);
+    static uint64_t TextureBytes(const WGPUTextureDescriptor &desc);
+
+    static void PrintReport();
+
+   private:
+    struct Allocation {
+        WMemoryCategory category;
+        uint64_t bytes;
+        std::string owner;
+    };
+
+    static std::mutex mutex;
+    static std::unordered_map<const void *, Allocation> allocations;
+    static std::array<WMemoryStats, (size_t)WMemoryCategory::Count> categories;
+    static WMemoryStats total;
+    static uint64_t budget;
+    static bool overBudget;
+    static WMemoryBudgetCallback budgetCallback;
+
+    static thread_local std::string currentOwner;
+
+    friend class WMemoryScope;
+};
+
+class WMemoryScope {
+   public:
+    explicit WMemoryScope(std::string owner);
+    WMemoryScope(const WMemoryScope &) = delete;
+    WMemoryScope &operator=(const WMemoryScope &) = delete;
+    ~WMemoryScope();
+
+    static inline const std::string &Current() { return WMemoryTracker::currentOwner; }
+
+   private:
+    std::string previous;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <WInclude.hpp>
+
+class WMipmapGenerator {
+   public:
+    static uint32_t MipLevelCount(WGPUExtent3D size);
+
+    static void Generate(WGPUDevice device, WGPUTexture texture, WGPUTextureDescriptor desc);
+
+    static void BeginBatch();
+    static void EndBatch(WGPUDevice device);
+    static void Flush(WGPUDevice device);
+    static void Clear(WGPUDevice device);
+
+   private:
+    struct Request {
+        WGPUTexture texture;
+        WGPUTextureDescriptor desc;
+    };
+
+    static std::vector<Request> pending;
+    static std::map<WGPUTextureFormat, WGPURenderPipeline> pipelines;
+    static WGPUShaderModule shader;
+    static WGPUSampler sampler;
+    static WGPUBindGroupLayout layout;
+    static uint32_t batchDepth;
+
+    static WGPURenderPipeline GetPipeline(WGPUDevice device, WGPUTextureFormat format);
+};
@@ -1,6 +1,15 @@
 #pragma once
 
 #include <WInclude.hpp>
+#include <WUtils.hpp>
+#include <WGeometryArena.hpp>
+#include <WUniformAllocator.hpp>
+#include <WAnimation.hpp>
+#include <WCamera.hpp>
+#include <WResource.hpp>
+
+#include <future>
+#include <optional>
 
 struct WModelVertex {
     glm::vec3 position;
@@ -15,47 +24,241 @@ struct WModelVertex {
     WModelVertex &withUV(glm::vec2 uv);
 };
 
+struct WModelCompactBounds {
+    glm::vec4 origin;
+    glm::vec4 extent;
+
+    static WModelCompactBounds FromVertices(std::span<const WModelVertex> vertices);
+};
+
+struct WMeshBounds {
+    glm::vec3 center;
+    glm::vec3 extent;
+    float radius;
+
+    static WMeshBounds FromVertices(std::span<const WModelVertex> vertices);
+    static WMeshBounds FromSkinnedVertices(std::span<const WModelVertex> vertices, const WSkeleton &skeleton);
+};
+
+struct WModelCullStats {
+    uint32_t visible = 0;
+    uint32_t culled = 0;
+};
+
+struct WModelCompactError {
+    float position = 0.0f;
+    float normalDegrees = 0.0f;
+    float uv = 0.0f;
+};
+
+struct WModelCompactVertex {
+    uint16_t position[4];
+    int16_t normal[2];
+    uint16_t uv[2];
+
+    static WVertexLayout desc();
+    static WModelCompactVertex Encode(const WModelVertex &vertex,
+                                      const WModelCompactBounds &bounds,
+                                      WModelCompactError *error = nullptr);
+};
+
+struct WModelSkinnedVertex {
+    WModelVertex vertex;
+    WModelSkin skin;
+
+    static WVertexLayout desc();
+};
+
+struct WModelCompactSkinnedVertex {
+    WModelCompactVertex vertex;
+    WModelSkin skin;
+
+    static WVertexLayout desc();
+};
+
+struct WModelInstance {
+    glm::mat4 transform;
+    glm::vec4 tint;
+
+    static WVertexLayout desc();
+};
+
+struct WModelUniform {
+    glm::mat4 transform;
+    uint32_t jointOffset;
+    uint32_t padding[3];
+};
+
+struct WTextureStreamingStats {
+    uint64_t residentBytes = 0;
+    uint64_t budget = 0;
+    uint32_t textures = 0;
+    uint32_t uploads = 0;
+    uint32_t evictions = 0;
+};
+
+class WTextureCache {
+   public:
+    static WTexture New(WGPUDevice device, std::string path, std::string fallback = "");
+    static WTexture New(WGPUDevice device, std::string path, const void *data, size_t size);
+    static WTexture New(WGPUDevice device, std::string path, const void *pixels, uint32_t width, uint32_t height);
+    static void RemoveTexture(std::string path);
+    static const WTexture &GetTexture(std::string path);
+
+    static void Request(const std::string &path, float pixels);
+    static void SetStreaming(bool enabled);
+    static void SetBudget(uint64_t bytes);
+    static void Evict(uint64_t bytes);
+    static void SetDeletionQueue(WDeletionQueue *deletionQueue);
+
+    static bool Update(WGPUDevice device);
+    static void Flush(WGPUDevice device);
+    static void Clear();
+    static inline uint64_t GetGeneration() { return generation; }
+    static WTextureStreamingStats GetStats();
+
+   private:
+    static constexpr uint32_t NotResident = UINT32_MAX;
+    static constexpr uint32_t StreamingBaseSize = 64;
+    static constexpr uint32_t MaxUploadsPerUpdate = 4;
+
+    struct Entry {
+        WTexture texture;
+        std::future<WImage> pending;
+        std::string owner;
+        std::optional<WImage> image;
+        uint32_t residentLevel = NotResident;
+        uint64_t residentBytes = 0;
+        float requestedPixels = 0.0f;
+        uint64_t lastUsed = 0;
+    };
+
+    static std::map<std::string, Entry> cache;
+    static std::optional<WTexture> placeholder;
+    static uint64_t generation;
+    static uint64_t frame;
+    static bool streaming;
+    static uint64_t budget;
+    static uint64_t pendingEviction;
+    static bool pressured;
+    static WDeletionQueue *deletionQueue;
+    static WTextureStreamingStats stats;
+
+    static WTexture Schedule(WGPUDevice device, std::string path, std::function<WImage()> decode);
+    static const WTexture &GetPlaceholder(WGPUDevice device);
+    static uint64_t Limit();
+    static uint32_t StartLevel(const WImage &image);
+    static uint32_t DesiredLevel(const Entry &entry);
+    static uint64_t LevelBytes(const WImage &image, uint32_t level);
+    static void Upload(WGPUDevice device, const std::string &path, Entry &entry);
+    static void MakeResident(WGPUDevice device, Entry &entry, uint32_t level);
+    static void Retire(Entry &entry);
+};
+
 class WMesh {
    public:
-    static WMesh New(WRenderBundle renderBundle, std::vector<WTexture> textures, std::vector<WBindGroup> bindGroups);
+    static WMesh New(WGPUDevice device,
+                     WRenderBuffer renderBuffer,
+                     WGPUBindGroupLayout localLayout,
+                     WUniformAllocator *uniformAllocator,
+                     std::vector<WUniformSlice> uniforms,
+                     std::vector<std::string> texturePaths,
+                     std::optional<WMeshBounds> bounds = std::nullopt,
+                     WJointPalette *palette = nullptr,
+                     bool ownsRenderBuffer = false);
 
-    void render(WGPURenderPassEncoder encoder);
+    bool refreshTextures(WGPUDevice device);
 
-    inline operator WGPURenderBundle() const { return renderBundle; }
-    inline const WGPURenderBundle &getRenderBundle() const { return renderBundle.getRenderBundle(); }
+    inline const WRenderBuffer &getRenderBuffer() const { return renderBuffer; }
+    inline const std::vector<std::string> &getTexturePaths() const { return texturePaths; }
+    inline const WBindGroup &getLocalGroup() const { return localGroup.get(); }
+    inline const std::optional<WMeshBounds> &getBounds() const { return bounds; }
 
    private:
-    WRenderBundle renderBundle;
+    WRenderBuffer renderBuffer;
+    WGPUBindGroupLayout localLayout;
+    WUniformAllocator *uniformAllocator;
+    std::vector<WUniformSlice> uniforms;
+    std::vector<std::string> texturePaths;
     std::vector<WTexture> textures;
-    std::vector<WBindGroup> bindGroups;
+    std::optional<WMeshBounds> bounds;
+    WJointPalette *palette = nullptr;
+    WOwned<WBindGroup> localGroup;
+    WOwned<WRenderBuffer> ownedRenderBuffer;
+
+    void buildLocalGroup(WGPUDevice device);
 };
 
 class WModel {
    public:
-    static WModel New(std::string path,
+    static WModel New(WGPUDevice device,
+                      std::string path,
                       std::vector<WMesh> meshes,
+                      WRenderBundleBuilder bundleBuilder,
                       WRenderPipeline pipeline,
-                      WUniformBuffer modelBuffer,
-                      glm::mat4 modelData = glm::mat4{1.0f});
-    static WModel New(std::vector<WMesh> meshes,
+                      WUniformAllocator *uniformAllocator,
+                      WUniformSlice modelSlice,
+                      glm::mat4 modelData = glm::mat4{1.0f},
+                      bool instanced = false);
+    static WModel New(WGPUDevice device,
+                      std::vector<WMesh> meshes,
+                      WRenderBundleBuilder bundleBuilder,
                       WRenderPipeline pipeline,
-                      WUniformBuffer modelBuffer,
-                      glm::mat4 modelData = glm::mat4{1.0f});
+                      WUniformAllocator *uniformAllocator,
+                      WUniformSlice modelSlice,
+                      glm::mat4 modelData = glm::mat4{1.0f},
+                      bool instanced = false);
 
     void render(WGPURenderPassEncoder encoder);
-    void updateModel(WGPUQueue queue, glm::mat4 model);
+    void render(WGPURenderPassEncoder encoder, const WFrustum &frustum);
+    void requestTextures(const WFrustum &frustum, glm::vec3 eye, float pixelsPerUnit) const;
+    void updateModel(glm::mat4 model);
+    void updateAnimation(float dt);
+    void setInstances(WGPUDevice device, std::span<const WModelInstance> instances);
+    bool refreshTextures(WGPUDevice device);
+
+    void setSkeleton(WSkeleton skeleton, WJointPalette *palette, uint32_t jointOffset);
+    void setPipelineSource(WRenderPipelineBuilder pipelineBuilder, const char *vertexEntry, const char *fragmentEntry);
+    WRenderPipeline buildPipeline(WGPUDevice device, WGPUShaderModule vertexShader, WGPUShaderModule fragmentShader) const;
+    void setPipeline(WGPUDevice device, WRenderPipeline pipeline);
+
+    inline const WModelCullStats &getCullStats() const { return cullStats; }
+    inline uint32_t getInstanceCount() const { return instanced ? instanceCount : 1; }
 
    private:
     std::vector<WMesh> meshes;
-    std::vector<WGPURenderBundle> renderBundles;
+    WRenderBundleBuilder bundleBuilder;
+    std::vector<WOwned<WGPURenderBundle>> renderBundles;
+    std::vector<WGPURenderBundle> visibleBundles;
+    WModelCullStats cullStats;
+    uint64_t textureGeneration = 0;
     WRenderPipeline pipeline;
-    WUniformBuffer modelBuffer;
-    glm::mat4 modelData;
-    WGPUShaderModule shader;
+    WRenderPipelineBuilder pipelineBuilder;
+    const char *vertexEntry = nullptr;
+    const char *fragmentEntry = nullptr;
+    WUniformAllocator *uniformAllocator = nullptr;
+    WUniformSlice modelSlice;
+    WModelUniform modelData{};
+
+    std::optional<WSkeleton> skeleton;
+    WJointPalette *palette = nullptr;
+    float animationTime = 0.0f;
+
+    bool instanced = false;
+    WOwned<WGPUBuffer> instanceBuffer;
+    uint32_t instanceCapacity = 0;
+    uint32_t instanceCount = 0;
+    std::vector<std::optional<WMeshBounds>> instanceBounds;
+    float instanceScale = 1.0f;
 
     std::string path;
     std::string name;
     std::string directory;
+
+    void record(WGPUDevice device);
+    inline const std::optional<WMeshBounds> &getCullBounds(size_t mesh) const {
+        return instanced ? instanceBounds[mesh] : meshes[mesh].getBounds();
+    }
 };
 
 class WModelBuilder {
@@ -67,7 +270,19 @@ class WModelBuilder {
     WModelBuilder &setGlobalBindGroup(WBindGroup bindGroup);
     WModelBuilder &setColorTarget(WGPUTextureFormat format);
     WModelBuilder &setVertexShader(WGPUShaderModule vshader, const char *entry = "vs_main");
+    WModelBuilder &setSkinnedVertexEntry(const char *entry);
+    WModelBuilder &setInstancedVertexEntries(const char *entry, const char *skinnedEntry);
     WModelBuilder &setFragmentShader(WGPUShaderModule fshader, const char *entry = "fs_main");
+    WModelBuilder &setCachePath(std::string cachePath);
+    WModelBuilder &setCacheEnabled(bool enabled);
+    WModelBuilder &setThreadCount(uint32_t threadCount);
+    WModelBuilder &setGeometryArena(WGeometryArena *arena);
+    WModelBuilder &setUniformAllocator(WUniformAllocator *allocator);
+    WModelBuilder &setCompactVertices(bool compact);
+    WModelBuilder &setOptimizeMeshes(bool optimize);
+    WModelBuilder &setOptimizeOverdraw(bool optimize);
+    WModelBuilder &setJointPalette(WJointPalette *palette);
+    WModelBuilder &setInstanced(bool instanced);
 
     WModel buildFromFile(WGPUDevice device);
 
@@ -79,4 +294,17 @@ class WModelBuilder {
     WGPUShaderModule fshader;
     const char *ventry;
     const char *fentry;
+    const char *skinnedEntry = "vs_skinned";
+    const char *instancedEntry = "vs_instanced";
+    const char *skinnedInstancedEntry = "vs_skinned_instanced";
+    std::string cachePath;
+    bool cacheEnabled = true;
+    uint32_t threadCount = 0;
+    WGeometryArena *geometryArena = nullptr;
+    WUniformAllocator *uniformAllocator = nullptr;
+    bool compactVertices = false;
+    bool optimizeMeshes = true;
+    bool optimizeOverdraw = false;
+    WJointPalette *jointPalette = nullptr;
+    bool instanced = false;
 };
\ No newline at end of file
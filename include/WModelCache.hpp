@@ -0,0 +1,103 @@
+#pragma once
+
+#include <WModel.hpp>
+#include <WAnimation.hpp>
+
+#include <optional>
+
+class WMappedFile {
+   public:
+    static WMappedFile Open(const std::string &path);
+
+    WMappedFile() = default;
+    WMappedFile(const WMappedFile &) = delete;
+    WMappedFile &operator=(const WMappedFile &) = delete;
+    WMappedFile(WMappedFile &&other) noexcept;
+    WMappedFile &operator=(WMappedFile &&other) noexcept;
+    ~WMappedFile();
+
+    inline bool isOpen() const { return bytes != nullptr; }
+    inline const unsigned char *data() const { return bytes; }
+    inline size_t size() const { return length; }
+    inline std::span<const unsigned char> span() const { return {bytes, length}; }
+
+   private:
+    const unsigned char *bytes = nullptr;
+    size_t length = 0;
+#ifdef WENGINE_PLATFORM_WINDOWS
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+
+    void close();
+};
+
+struct WImportedMesh {
+    std::vector<WModelVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<WModelSkin> skins;
+    uint32_t materialIndex;
+};
+
+struct WImportedMaterial {
+    std::string diffuse;
+    std::vector<unsigned char> embedded;
+    uint32_t embeddedWidth = 0;
+    uint32_t embeddedHeight = 0;
+};
+
+struct WMeshData {
+    std::span<const WModelVertex> vertices;
+    std::span<const uint32_t> indices;
+    std::span<const WModelSkin> skins;
+    uint32_t materialIndex;
+};
+
+struct WMaterialData {
+    std::string diffuse;
+    std::span<const unsigned char> embedded;
+    uint32_t embeddedWidth = 0;
+    uint32_t embeddedHeight = 0;
+};
+
+class WModelData {
+   public:
+    static std::optional<WModelData> FromBytes(std::vector<unsigned char> bytes);
+    static std::optional<WModelData> FromFile(WMappedFile file);
+
+    std::vector<WMeshData> meshes;
+    std::vector<WMaterialData> materials;
+    std::optional<WSkeleton> skeleton;
+
+   private:
+    std::vector<unsigned char> bytes;
+    WMappedFile file;
+
+    bool parse(std::span<const unsigned char> blob);
+};
+
+struct WModelCacheKey {
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint32_t importFlags;
+    uint32_t optimizeFlags;
+};
+
+class WModelCache {
+   public:
+    static constexpr uint32_t MAGIC = 0x4C444D57;  // "WMDL"
+    static constexpr uint32_t VERSION = 4;
+
+    static WModelCacheKey KeyFor(const WMappedFile &source, uint32_t importFlags, uint32_t optimizeFlags = 0);
+
+    static std::optional<WModelData> Load(const std::string &path, const WModelCacheKey &key);
+    static bool Store(const std::string &path, const std::vector<unsigned char> &bytes);
+
+    static std::vector<unsigned char> Serialize(const WModelCacheKey &key,
+                                                const std::vector<WImportedMesh> &meshes,
+                                                const std::vector<WImportedMaterial> &materials,
+                                                const WSkeleton *skeleton = nullptr);
+
+   private:
+    static uint64_t Hash(std::span<const unsigned char> bytes);
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <WInclude.hpp>
+
+#include <mutex>
+#include <set>
+#include <type_traits>
+
+struct WCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t size = 0;
+};
+
+class WCacheKey {
+   public:
+    template <typename T>
+    WCacheKey &add(const T &value) {
+        static_assert(std::is_scalar_v<T>, "Add fields one by one so padding never ends up in the key");
+        bytes.append((const char *)&value, sizeof(T));
+        return *this;
+    }
+    WCacheKey &add(const char *text);
+
+    inline const std::string &str() const { return bytes; }
+
+   private:
+    std::string bytes;
+};
+
+template <typename Handle>
+class WHandleCache {
+   public:
+    Handle getOrCreate(WGPUDevice device, const WCacheKey &key, const std::function<Handle()> &create) {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto found = handles.find({device, key.str()});
+        if (found != handles.end()) {
+            stats.hits++;
+            return found->second;
+        }
+
+        stats.misses++;
+        Handle handle = create();
+        handles.emplace(std::make_pair(device, key.str()), handle);
+        stats.size = handles.size();
+        return handle;
+    }
+
+    void erase(WGPUDevice device, const std::string &key, const std::function<void(const Handle &)> &release) {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto found = handles.find({device, key});
+        if (found != handles.end()) {
+            release(found->second);
+            handles.erase(found);
+            stats.size = handles.size();
+        }
+    }
+    void clear(WGPUDevice device, const std::function<void(const Handle &)> &release) {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (auto it = handles.begin(); it != handles.end();) {
+            if (it->first.first == device) {
+                release(it->second);
+                it = handles.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        stats.size = handles.size();
+    }
+
+    inline const WCacheStats &getStats() const { return stats; }
+
+   private:
+    std::map<std::pair<WGPUDevice, std::string>, Handle> handles;
+    WCacheStats stats;
+    std::mutex mutex;
+};
+
+class WPipelineCache {
+   public:
+    static WRenderPipeline GetOrCreate(WGPUDevice device,
+                                       const WCacheKey &key,
+                                       const std::function<WRenderPipeline()> &create,
+                                       std::initializer_list<WGPUShaderModule> shaders = {});
+    static WGPUSampler GetOrCreateSampler(WGPUDevice device, const WCacheKey &key, const std::function<WGPUSampler()> &create);
+    static WGPUBindGroupLayout GetOrCreateBindGroupLayout(WGPUDevice device,
+                                                          const WCacheKey &key,
+                                                          const std::function<WGPUBindGroupLayout()> &create);
+    static WGPUPipelineLayout GetOrCreatePipelineLayout(WGPUDevice device,
+                                                        const WCacheKey &key,
+                                                        const std::function<WGPUPipelineLayout()> &create);
+
+    static inline const WCacheStats &GetStats() { return renderPipelines.getStats(); }
+    static inline const WCacheStats &GetSamplerStats() { return samplers.getStats(); }
+    static inline const WCacheStats &GetBindGroupLayoutStats() { return bindGroupLayouts.getStats(); }
+    static inline const WCacheStats &GetPipelineLayoutStats() { return pipelineLayouts.getStats(); }
+    static void PrintStats();
+    static void EvictShader(WGPUDevice device, WGPUShaderModule shader);
+    static void Clear(WGPUDevice device);
+
+   private:
+    static WHandleCache<WRenderPipeline> renderPipelines;
+    static WHandleCache<WGPUSampler> samplers;
+    static WHandleCache<WGPUBindGroupLayout> bindGroupLayouts;
+    static WHandleCache<WGPUPipelineLayout> pipelineLayouts;
+
+    static std::mutex shaderMutex;
+    static std::map<std::pair<WGPUDevice, WGPUShaderModule>, std::set<std::string>> shaderPipelines;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <WInclude.hpp>
+
+#include <atomic>
+
+#ifdef WENGINE_PROFILE
+#define WPROFILE_CONCAT_INNER(a, b) a##b
+#define WPROFILE_CONCAT(a, b) WPROFILE_CONCAT_INNER(a, b)
+#define WPROFILE_SCOPE(name) WProfileZone WPROFILE_CONCAT(profileZone, __LINE__)(name)
+#define WPROFILE_FUNCTION() WPROFILE_SCOPE(__func__)
+#define WPROFILE_THREAD(name) WProfiler::SetThreadName(name)
+#else
+#define WPROFILE_SCOPE(name)
+#define WPROFILE_FUNCTION()
+#define WPROFILE_THREAD(name)
+#endif
+
+struct WProfileEvent {
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+};
+
+class WProfiler {
+   public:
+    static uint64_t Now();
+    static void Record(const char *name, uint64_t start, uint64_t end);
+    static void SetThreadName(const char *name);
+
+    static bool WriteChromeTrace(const std::string &path);
+
+   private:
+    static constexpr uint32_t CHUNK_SIZE = 4096;
+
+    struct Chunk {
+        WProfileEvent events[CHUNK_SIZE];
+        std::atomic<uint32_t> count{0};
+        std::atomic<Chunk *> next{nullptr};
+    };
+
+    struct ThreadBuffer {
+        uint32_t id;
+        std::atomic<const char *> name{nullptr};
+        Chunk head;
+        Chunk *tail = &head;
+        ThreadBuffer *next = nullptr;
+    };
+
+    static std::atomic<ThreadBuffer *> threads;
+    static std::atomic<uint32_t> threadCount;
+
+    static ThreadBuffer &LocalBuffer();
+};
+
+class WProfileZone {
+   public:
+    explicit WProfileZone(const char *name) : name(name), start(WProfiler::Now()) {}
+    WProfileZone(const WProfileZone &) = delete;
+    WProfileZone &operator=(const WProfileZone &) = delete;
+    ~WProfileZone() { WProfiler::Record(name, start, WProfiler::Now()); }
+
+   private:
+    const char *name;
+    uint64_t start;
+};
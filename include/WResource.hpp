@@ -0,0 +1,109 @@
+#pragma once
+
+#include <WInclude.hpp>
+
+#include <deque>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+inline void WRelease(WGPUTextureView view) { wgpuTextureViewRelease(view); }
+inline void WRelease(WGPUSampler sampler) { wgpuSamplerRelease(sampler); }
+inline void WRelease(WGPUBindGroup bindGroup) { wgpuBindGroupRelease(bindGroup); }
+inline void WRelease(WGPUBindGroupLayout layout) { wgpuBindGroupLayoutRelease(layout); }
+inline void WRelease(WGPUPipelineLayout layout) { wgpuPipelineLayoutRelease(layout); }
+inline void WRelease(WGPURenderPipeline pipeline) { wgpuRenderPipelineRelease(pipeline); }
+inline void WRelease(WGPURenderBundle bundle) { wgpuRenderBundleRelease(bundle); }
+inline void WRelease(WGPUShaderModule module) { wgpuShaderModuleRelease(module); }
+inline void WRelease(WGPUQuerySet querySet) { wgpuQuerySetRelease(querySet); }
+
+void WRelease(WGPUBuffer buffer);
+void WRelease(WGPUTexture texture);
+void WRelease(const WTexture &texture);
+void WRelease(const WUniformBuffer &buffer);
+void WRelease(const WRenderBuffer &renderBuffer);
+void WRelease(const WBindGroup &bindGroup);
+void WRelease(const WRenderBundle &bundle);
+
+template <typename T>
+void WDestroy(const T &resource) {
+    WRelease(resource);
+}
+void WDestroy(WGPUBuffer buffer);
+void WDestroy(WGPUTexture texture);
+void WDestroy(const WTexture &texture);
+void WDestroy(const WUniformBuffer &buffer);
+
+template <typename T>
+class WOwned {
+   public:
+    WOwned() = default;
+    explicit WOwned(T resource) {
+        if constexpr (std::is_pointer_v<T>) {
+            if (resource == nullptr) {
+                return;
+            }
+        }
+        this->resource = std::move(resource);
+    }
+    WOwned(const WOwned &) = delete;
+    WOwned &operator=(const WOwned &) = delete;
+    WOwned(WOwned &&other) noexcept : resource(std::exchange(other.resource, std::nullopt)) {}
+    WOwned &operator=(WOwned &&other) noexcept {
+        if (this != &other) {
+            reset();
+            resource = std::exchange(other.resource, std::nullopt);
+        }
+        return *this;
+    }
+    ~WOwned() { reset(); }
+
+    void reset() {
+        if (resource) {
+            WRelease(*resource);
+            resource.reset();
+        }
+    }
+    T release() {
+        T released = std::move(*resource);
+        resource.reset();
+        return released;
+    }
+
+    inline const T &get() const { return *resource; }
+    inline const T *operator->() const { return &*resource; }
+    inline explicit operator bool() const { return resource.has_value(); }
+
+   private:
+    std::optional<T> resource;
+};
+
+class WDeletionQueue {
+   public:
+    static WDeletionQueue New(WGPUQueue queue);
+
+    template <typename T>
+    void retire(WOwned<T> &&resource) {
+        if (resource) {
+            retire([released = resource.release()]() { WDestroy(released); });
+        }
+    }
+    void retire(std::function<void()> destroy);
+
+    void submit();
+    uint32_t collect();
+    void flush(WGPUDevice device);
+
+    inline size_t getPendingCount() const { return pendingCount; }
+
+   private:
+    struct Batch {
+        bool done = false;
+        std::vector<std::function<void()>> destroys;
+    };
+
+    WGPUQueue queue = nullptr;
+    std::vector<std::function<void()>> retired;
+    std::deque<std::unique_ptr<Batch>> batches;
+    size_t pendingCount = 0;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <WInclude.hpp>
+#include <WPipelineCache.hpp>
+#include <WShaderPreprocessor.hpp>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using WShaderReload = std::function<std::function<void()>(WGPUShaderModule)>;
+
+class WShaderLibrary {
+   public:
+    WShaderLibrary(WGPUDevice device, std::string directory);
+    WShaderLibrary(const WShaderLibrary &) = delete;
+    WShaderLibrary &operator=(const WShaderLibrary &) = delete;
+    ~WShaderLibrary();
+
+    WGPUShaderModule load(const std::string &path, const WShaderPermutation &permutation = {});
+    void subscribe(const std::string &path, const WShaderPermutation &permutation, WShaderReload reload);
+    uint32_t update();
+
+    inline const WCacheStats &getStats() const { return stats; }
+
+    static WGPUShaderModule Compile(WGPUDevice device, const std::string &label, const std::string &code);
+    static uint64_t Hash(const std::string &code);
+
+   private:
+    struct Entry {
+        std::string path;
+        WShaderPermutation permutation;
+        std::set<std::string> files;
+        WGPUShaderModule module = nullptr;
+        uint64_t hash = 0;
+        std::vector<WShaderReload> subscribers;
+    };
+
+    struct Reload {
+        std::string key;
+        std::string code;
+    };
+
+    WGPUDevice device;
+    std::string directory;
+    std::map<std::string, Entry> entries;
+    std::deque<Reload> reloads;
+    WCacheStats stats;
+    std::mutex mutex;
+    std::atomic<bool> stopping = false;
+    std::thread watcher;
+
+    void watch();
+    void reload(const std::string &file);
+    void release(WGPUShaderModule module);
+    std::set<std::string> watchedFiles();
+
+    static std::string Key(const std::string &path);
+    static std::string Key(const std::string &path, const WShaderPermutation &permutation);
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <WInclude.hpp>
+
+#include <set>
+
+struct WShaderPermutation {
+    std::map<std::string, std::string> defines;
+    std::map<std::string, double> constants;
+
+    WShaderPermutation &define(const std::string &name, const std::string &value = "");
+    WShaderPermutation &setConstant(const std::string &name, double value);
+
+    std::string key() const;
+};
+
+struct WShaderSource {
+    std::string code;
+    std::set<std::string> files;
+};
+
+class WShaderPreprocessor {
+   public:
+    static WShaderSource Process(const std::string &path, const WShaderPermutation &permutation);
+
+   private:
+    struct Condition {
+        bool active;
+        bool parentActive;
+        bool hasElse;
+    };
+
+    struct State {
+        std::map<std::string, std::string> defines;
+        const std::map<std::string, double> &constants;
+        std::set<std::string> baked;
+        WShaderSource source;
+    };
+
+    static void ProcessFile(const std::string &path, State &state);
+    static std::string Substitute(const std::string &line, const std::map<std::string, std::string> &defines);
+    static std::string BakeOverride(const std::string &line,
+                                    const std::map<std::string, double> &constants,
+                                    std::set<std::string> &baked);
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <WInclude.hpp>
+
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <type_traits>
+
+class WThreadPool {
+   public:
+    explicit WThreadPool(uint32_t threadCount);
+    WThreadPool(const WThreadPool &) = delete;
+    WThreadPool &operator=(const WThreadPool &) = delete;
+    ~WThreadPool();
+
+    template <typename Function>
+    auto submit(Function function) -> std::future<std::invoke_result_t<Function>> {
+        using Result = std::invoke_result_t<Function>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+        std::future<Result> future = task->get_future();
+        if (workers.empty()) {
+            (*task)();
+        } else {
+            enqueue([task]() { (*task)(); });
+        }
+        return future;
+    }
+
+    void parallelFor(size_t count, const std::function<void(size_t)> &function);
+
+    inline uint32_t getThreadCount() const { return workers.size(); }
+
+    static uint32_t HardwareThreads();
+
+   private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+
+    void enqueue(std::function<void()> task);
+    void work();
+};
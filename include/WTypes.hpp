@@ -47,6 +47,37 @@ class WDepthState {
     bool depthWriteEnabled = true;
 };
 
+class WImage {
+   public:
+    struct Level {
+        uint32_t width;
+        uint32_t height;
+        size_t offset;
+        size_t size;
+    };
+
+    static WImage fromFileAsRgba8(std::string path, bool flipUV = true);
+    static WImage fromMemoryAsRgba8(const void *data, size_t size, bool flipUV = true);
+    static WImage fromRgba8(const void *pixels, uint32_t width, uint32_t height);
+    static WImage fromKtx2File(std::string path, bool allowBC);
+
+    void generateMipmaps();
+    uint32_t getMaxBaseLevel() const;
+
+    inline uint32_t getWidth() const { return width; }
+    inline uint32_t getHeight() const { return height; }
+    inline WGPUTextureFormat getFormat() const { return format; }
+    inline const std::vector<Level> &getLevels() const { return levels; }
+    inline const std::vector<unsigned char> &getPixels() const { return pixels; }
+
+   private:
+    uint32_t width;
+    uint32_t height;
+    WGPUTextureFormat format = WGPUTextureFormat_RGBA8Unorm;
+    std::vector<Level> levels;
+    std::vector<unsigned char> pixels;
+};
+
 class WTexture {
    public:
     static WTexture New(WGPUTexture texture, WGPUTextureDescriptor desc);
@@ -57,6 +88,7 @@ class WTexture {
     inline operator WGPUTextureView() const { return view; };
     inline operator WGPUTextureDescriptor() const { return desc; };
 
+    static WTexture fromImage(WGPUDevice device, const WImage &image, uint32_t baseLevel = 0);
     static WTexture fromFileAsRgba8(WGPUDevice device, std::string path, bool flipUV = true);
     static WTexture fromMemoryAsRgba8(WGPUDevice device, const void *data, size_t size, bool flipUV = true);
 
@@ -72,8 +104,8 @@ class WUniformBuffer {
 
     inline operator WGPUBuffer() const { return buffer; }
 
-    void update(WGPUQueue queue, void *data);
-    void updateWithOffset(WGPUQueue queue, void *data, uint32_t offset);
+    void update(WGPUQueue queue, void *data) const;
+    void updateWithOffset(WGPUQueue queue, void *data, uint32_t offset) const;
 
     inline size_t getSize() const { return size; }
 
@@ -84,7 +116,9 @@ class WUniformBuffer {
 
 class WBindGroup {
    public:
-    static WBindGroup New(WGPUBindGroup bindGroup, WGPUBindGroupLayout bindGroupLayout);
+    static WBindGroup New(WGPUBindGroup bindGroup,
+                          WGPUBindGroupLayout bindGroupLayout,
+                          std::vector<uint32_t> dynamicOffsets = {});
 
     inline operator WGPUBindGroup() const { return bindGroup; }
     inline operator WGPUBindGroupLayout() const { return bindGroupLayout; }
@@ -95,6 +129,7 @@ class WBindGroup {
    private:
     WGPUBindGroup bindGroup;
     WGPUBindGroupLayout bindGroupLayout;
+    std::vector<uint32_t> dynamicOffsets;
 };
 
 class WVertexLayout {
@@ -120,11 +155,33 @@ class WRenderBuffer {
                              const void *vertices,
                              size_t verticesSize,
                              size_t verticesCount,
-                             const uint32_t *indices,
-                             size_t indicesCount);
+                             const void *indices,
+                             size_t indicesCount,
+                             WGPUIndexFormat indexFormat = WGPUIndexFormat_Uint32);
+    static WRenderBuffer New(WGPUBuffer vertex,
+                             WGPUBuffer index,
+                             size_t verticesSize,
+                             size_t verticesCount,
+                             size_t indicesCount,
+                             uint32_t baseVertex,
+                             uint32_t firstIndex,
+                             WGPUIndexFormat indexFormat = WGPUIndexFormat_Uint32);
+    static size_t IndexSize(WGPUIndexFormat indexFormat);
 
     void render(WGPURenderPassEncoder encoder);
     void render(WGPURenderBundleEncoder encoder);
+    void bind(WGPURenderBundleEncoder encoder);
+    void draw(WGPURenderBundleEncoder encoder, uint32_t instanceCount = 1);
+
+    inline WGPUBuffer getVertexBuffer() const { return vertex; }
+    inline WGPUBuffer getIndexBuffer() const { return index; }
+    inline size_t getVerticesSize() const { return verticesSize; }
+    inline size_t getVerticesCount() const { return verticesCount; }
+    inline size_t getIndicesSize() const { return indicesSize; }
+    inline size_t getIndicesCount() const { return indicesCount; }
+    inline uint32_t getBaseVertex() const { return baseVertex; }
+    inline uint32_t getFirstIndex() const { return firstIndex; }
+    inline WGPUIndexFormat getIndexFormat() const { return indexFormat; }
 
    private:
     WGPUBuffer vertex;
@@ -133,6 +190,9 @@ class WRenderBuffer {
     size_t indicesSize;
     size_t verticesCount;
     size_t indicesCount;
+    uint32_t baseVertex = 0;
+    uint32_t firstIndex = 0;
+    WGPUIndexFormat indexFormat = WGPUIndexFormat_Uint32;
 };
 
 class WRenderPipeline {
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <WInclude.hpp>
+#include <WGeometryArena.hpp>
+
+struct WUniformSlice {
+    uint32_t offset;
+    uint32_t size;
+};
+
+class WUniformAllocator {
+   public:
+    static WUniformAllocator New(WGPUDevice device, uint32_t alignment, uint64_t capacity = 4ull << 20);
+
+    WUniformSlice allocate(uint32_t size);
+    void free(WUniformSlice slice);
+
+    void write(WUniformSlice slice, const void *data);
+    void upload(WGPUQueue queue);
+
+    inline WGPUBuffer getBuffer() const { return buffer.get(); }
+    inline uint32_t getAlignment() const { return alignment; }
+    inline uint64_t getUsed() const { return freeList.getUsed(); }
+
+   private:
+    WOwned<WGPUBuffer> buffer;
+    std::vector<unsigned char> shadow;
+    WFreeList freeList;
+    uint32_t alignment;
+    uint64_t dirtyBegin = UINT64_MAX;
+    uint64_t dirtyEnd = 0;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <WInclude.hpp>
+#include <WPipelineCache.hpp>
 
 class WRenderPassBuilder {
    public:
@@ -8,12 +9,14 @@ class WRenderPassBuilder {
 
     WRenderPassBuilder &addColorTarget(WColorAttachment attachment);
     WRenderPassBuilder &setDepthAttachment(WDepthStencilAttachment attachment);
+    WRenderPassBuilder &setTimestampWrites(const WGPURenderPassTimestampWrites *timestampWrites);
 
     WGPURenderPassEncoder build(WGPUCommandEncoder commandEncoder, const char *label = "Render Pass Endoder");
 
    private:
     std::vector<WGPURenderPassColorAttachment> colorAttachments;
     WGPURenderPassDepthStencilAttachment depthStencilAttachment;
+    const WGPURenderPassTimestampWrites *timestampWrites = nullptr;
     bool depthTest = false;
     bool stencilTest = false;
 };
@@ -29,6 +32,7 @@ class WTextureBuilder {
     WTextureBuilder &setFormat(WGPUTextureFormat format);
     WTextureBuilder &setMipLevelCount(uint32_t count);
     WTextureBuilder &setSampleCount(uint32_t count);
+    WTextureBuilder &setGenerateMipmaps(bool generate);
 
     WTexture build(WGPUDevice device,
                    WGPUExtent3D size,
@@ -44,6 +48,7 @@ class WTextureBuilder {
         .mipLevelCount = 1,
         .sampleCount = 1,
     };
+    bool generateMipmaps = false;
 };
 
 class WSamplerBuilder {
@@ -74,7 +79,7 @@ class WSamplerBuilder {
         .minFilter = WGPUFilterMode_Linear,
         .mipmapFilter = WGPUMipmapFilterMode_Linear,
         .lodMinClamp = 0.0f,
-        .lodMaxClamp = 1.0f,
+        .lodMaxClamp = 32.0f,
         .compare = WGPUCompareFunction_Undefined,
         .maxAnisotropy = 1,
     };
@@ -92,7 +97,10 @@ class WBindGroupLayoutBuilder {
     WBindGroupLayoutBuilder &addBindingUniform(uint32_t binding,
                                                WGPUShaderStageFlags visibility = WGPUShaderStage_Vertex |
                                                                                  WGPUShaderStage_Fragment |
-                                                                                 WGPUShaderStage_Compute);
+                                                                                 WGPUShaderStage_Compute,
+                                               bool hasDynamicOffset = false);
+    WBindGroupLayoutBuilder &addBindingStorage(uint32_t binding,
+                                               WGPUShaderStageFlags visibility = WGPUShaderStage_Vertex);
     WGPUBindGroupLayout build(WGPUDevice device);
 
    private:
@@ -116,6 +124,12 @@ class WBindGroupBuilder {
                                          WGPUShaderStageFlags visibility = WGPUShaderStage_Vertex |
                                                                            WGPUShaderStage_Fragment |
                                                                            WGPUShaderStage_Compute);
+    WBindGroupBuilder &addBindingUniformDynamic(uint32_t binding, WGPUBuffer buffer, size_t size, uint32_t dynamicOffset,
+                                                WGPUShaderStageFlags visibility = WGPUShaderStage_Vertex |
+                                                                                  WGPUShaderStage_Fragment |
+                                                                                  WGPUShaderStage_Compute);
+    WBindGroupBuilder &addBindingStorage(uint32_t binding, WGPUBuffer buffer, size_t size,
+                                         WGPUShaderStageFlags visibility = WGPUShaderStage_Vertex);
 
     WBindGroup build(WGPUDevice device);
     WBindGroup buildWithLayout(WGPUDevice device, WGPUBindGroupLayout layout);
@@ -125,7 +139,10 @@ class WBindGroupBuilder {
 
    private:
     std::vector<WGPUBindGroupEntry> entries;
+    std::map<uint32_t, uint32_t> dynamicOffsets;
     WBindGroupLayoutBuilder layoutBuilder;
+
+    std::vector<uint32_t> getDynamicOffsets() const;
 };
 
 class WRenderBufferBuilder {
@@ -134,21 +151,30 @@ class WRenderBufferBuilder {
 
     template <typename Vertex>
     WRenderBufferBuilder &setVertices(const std::vector<Vertex> &vertices) {
+        return setVertices(std::span<const Vertex>(vertices));
+    }
+    template <typename Vertex>
+    WRenderBufferBuilder &setVertices(std::span<const Vertex> vertices) {
         this->vertices = vertices.data();
         this->verticesCount = vertices.size();
         this->verticesSize = sizeof(Vertex) * this->verticesCount;
         return *this;
     }
-    WRenderBufferBuilder &setIndices(const std::vector<uint32_t> &indices);
+    WRenderBufferBuilder &setIndices(std::span<const uint32_t> indices);
+    WRenderBufferBuilder &setAllowNarrowIndices(bool allow);
 
     WRenderBuffer build(WGPUDevice device);
 
+    static bool CanNarrowIndices(size_t verticesCount);
+    static std::vector<uint16_t> NarrowIndices(std::span<const uint32_t> indices);
+
    private:
     const void *vertices;
     const uint32_t *indices;
     size_t verticesSize;
     size_t verticesCount;
     size_t indicesCount;
+    bool allowNarrowIndices = true;
 };
 
 class WPipelineLayoutBuilder {
@@ -159,6 +185,8 @@ class WPipelineLayoutBuilder {
 
     WGPUPipelineLayout build(WGPUDevice device);
 
+    inline const std::vector<WGPUBindGroupLayout> &getBindGroupLayouts() const { return bindGroupLayouts; }
+
    private:
     std::vector<WGPUBindGroupLayout> bindGroupLayouts;
 };
@@ -190,6 +218,8 @@ class WRenderPipelineBuilder {
     WGPUDepthStencilState depthStencilState;
     bool depthTest = false;
     bool stencilTest = false;
+
+    WCacheKey cacheKey() const;
 };
 
 class WRenderBundleBuilder {
@@ -202,13 +232,24 @@ class WRenderBundleBuilder {
     WRenderBundleBuilder &setDepthFormat(WGPUTextureFormat format);
     WRenderBundleBuilder &setRenderPipeline(WRenderPipeline pipeline);
     WRenderBundleBuilder &setDefaultDepthFormat() { return setDepthFormat(WGPUTextureFormat_Depth32Float); }
+    WRenderBundleBuilder &addDraw(WRenderBuffer renderBuffer, WBindGroup bindGroup);
+    WRenderBundleBuilder &clearDraws();
+    WRenderBundleBuilder &setInstanceBuffer(WGPUBuffer buffer, uint32_t instanceCount);
 
     WRenderBundle build(WGPUDevice device);
 
    private:
+    struct Draw {
+        WRenderBuffer renderBuffer;
+        WBindGroup bindGroup;
+    };
+
     WRenderBuffer renderBuffer;
+    std::vector<Draw> draws;
     std::vector<WBindGroup> bindGroups;
     std::vector<WGPUTextureFormat> colorFormats;
     WGPUTextureFormat depthFormat;
     WRenderPipeline pipeline;
+    WGPUBuffer instanceBuffer = nullptr;
+    uint32_t instanceCount = 1;
 };
@@ -0,0 +1,219 @@
+#include <WAnimation.hpp>
+#include <WMemoryTracker.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+class WByteWriter {
+   public:
+    std::vector<unsigned char> bytes;
+
+    template <typename T>
+    void write(const T &value) {
+        const unsigned char *data = (const unsigned char *)&value;
+        bytes.insert(bytes.end(), data, data + sizeof(T));
+    }
+    template <typename T>
+    void writeArray(const std::vector<T> &values) {
+        write((uint32_t)values.size());
+        const unsigned char *data = (const unsigned char *)values.data();
+        bytes.insert(bytes.end(), data, data + values.size() * sizeof(T));
+    }
+};
+
+class WByteReader {
+   public:
+    std::span<const unsigned char> bytes;
+    size_t offset = 0;
+    bool failed = false;
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (failed || bytes.size() - offset < sizeof(T)) {
+            failed = true;
+            return value;
+        }
+        memcpy(&value, bytes.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+    template <typename T>
+    std::vector<T> readArray() {
+        uint32_t count = read<uint32_t>();
+        if (failed || (bytes.size() - offset) / sizeof(T) < count) {
+            failed = true;
+            return {};
+        }
+        std::vector<T> values(count);
+        memcpy(values.data(), bytes.data() + offset, count * sizeof(T));
+        offset += count * sizeof(T);
+        return values;
+    }
+};
+
+template <typename Key>
+static size_t findKey(const std::vector<Key> &keys, float time) {
+    auto next = std::upper_bound(keys.begin(), keys.end(), time, [](float t, const Key &key) {
+        return t < key.time;
+    });
+    return next == keys.begin() ? 0 : (size_t)(next - keys.begin()) - 1;
+}
+static float keyFactor(float from, float to, float time) {
+    return to > from ? std::clamp((time - from) / (to - from), 0.0f, 1.0f) : 0.0f;
+}
+static glm::vec3 sampleVector(const std::vector<WVectorKey> &keys, float time) {
+    size_t i = findKey(keys, time);
+    if (i + 1 >= keys.size()) {
+        return keys[i].value;
+    }
+    return glm::mix(keys[i].value, keys[i + 1].value, keyFactor(keys[i].time, keys[i + 1].time, time));
+}
+static glm::quat sampleQuat(const std::vector<WQuatKey> &keys, float time) {
+    size_t i = findKey(keys, time);
+    if (i + 1 >= keys.size()) {
+        return keys[i].value;
+    }
+    return glm::normalize(glm::slerp(keys[i].value, keys[i + 1].value, keyFactor(keys[i].time, keys[i + 1].time, time)));
+}
+
+WVertexLayout WModelSkin::Append(WVertexLayout layout, size_t stride, size_t offset) {
+    return layout.setArrayStride(stride)
+        .addAttribute(WGPUVertexFormat_Uint16x4, offset + offsetof(WModelSkin, joints), 3)
+        .addAttribute(WGPUVertexFormat_Unorm8x4, offset + offsetof(WModelSkin, weights), 4);
+}
+
+void WSkeleton::sample(uint32_t clip, float seconds, std::span<glm::mat4> palette) const {
+    globals.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        globals[i] = nodes[i].transform;
+    }
+
+    if (clip < clips.size()) {
+        const WAnimationClip &animation = clips[clip];
+        float ticks = animation.duration > 0.0f ? std::fmod(seconds * animation.ticksPerSecond, animation.duration) : 0.0f;
+        for (const WAnimationChannel &channel : animation.channels) {
+            glm::mat4 local{1.0f};
+            if (!channel.positions.empty()) {
+                local = glm::translate(local, sampleVector(channel.positions, ticks));
+            }
+            if (!channel.rotations.empty()) {
+                local = local * glm::mat4_cast(sampleQuat(channel.rotations, ticks));
+            }
+            if (!channel.scales.empty()) {
+                local = glm::scale(local, sampleVector(channel.scales, ticks));
+            }
+            globals[channel.node] = local;
+        }
+    }
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].parent >= 0) {
+            globals[i] = globals[nodes[i].parent] * globals[i];
+        }
+    }
+    for (size_t i = 0; i < joints.size() && i < palette.size(); i++) {
+        palette[i] = globalInverse * globals[joints[i].node] * joints[i].offset;
+    }
+}
+
+std::vector<unsigned char> WSkeleton::serialize() const {
+    WByteWriter writer;
+    writer.write(globalInverse);
+    writer.writeArray(nodes);
+    writer.writeArray(joints);
+    writer.write((uint32_t)clips.size());
+    for (const WAnimationClip &clip : clips) {
+        writer.write(clip.duration);
+        writer.write(clip.ticksPerSecond);
+        writer.writeArray(std::vector<char>(clip.name.begin(), clip.name.end()));
+        writer.write((uint32_t)clip.channels.size());
+        for (const WAnimationChannel &channel : clip.channels) {
+            writer.write(channel.node);
+            writer.writeArray(channel.positions);
+            writer.writeArray(channel.rotations);
+            writer.writeArray(channel.scales);
+        }
+    }
+    return writer.bytes;
+}
+std::optional<WSkeleton> WSkeleton::Deserialize(std::span<const unsigned char> bytes) {
+    WByteReader reader{.bytes = bytes};
+    WSkeleton skeleton;
+    skeleton.globalInverse = reader.read<glm::mat4>();
+    skeleton.nodes = reader.readArray<WSkeletonNode>();
+    skeleton.joints = reader.readArray<WSkeletonJoint>();
+    uint32_t clipCount = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < clipCount && !reader.failed; i++) {
+        WAnimationClip clip;
+        clip.duration = reader.read<float>();
+        clip.ticksPerSecond = reader.read<float>();
+        std::vector<char> name = reader.readArray<char>();
+        clip.name.assign(name.begin(), name.end());
+        uint32_t channelCount = reader.read<uint32_t>();
+        for (uint32_t j = 0; j < channelCount && !reader.failed; j++) {
+            WAnimationChannel channel;
+            channel.node = reader.read<uint32_t>();
+            channel.positions = reader.readArray<WVectorKey>();
+            channel.rotations = reader.readArray<WQuatKey>();
+            channel.scales = reader.readArray<WVectorKey>();
+            clip.channels.push_back(std::move(channel));
+        }
+        skeleton.clips.push_back(std::move(clip));
+    }
+
+    if (reader.failed) {
+        return std::nullopt;
+    }
+    for (size_t i = 0; i < skeleton.nodes.size(); i++) {
+        if (skeleton.nodes[i].parent >= (int32_t)i) {
+            return std::nullopt;
+        }
+    }
+    for (const WSkeletonJoint &joint : skeleton.joints) {
+        if (joint.node >= skeleton.nodes.size()) {
+            return std::nullopt;
+        }
+    }
+    for (const WAnimationClip &clip : skeleton.clips) {
+        for (const WAnimationChannel &channel : clip.channels) {
+            if (channel.node >= skeleton.nodes.size()) {
+                return std::nullopt;
+            }
+        }
+    }
+    return skeleton;
+}
+
+WJointPalette WJointPalette::New(WGPUDevice device, uint32_t capacity) {
+    WJointPalette palette;
+    palette.joints.resize(capacity, glm::mat4{1.0f});
+
+    WGPUBufferDescriptor desc{
+        .label = "Joint Palette",
+        .usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst,
+        .size = capacity * sizeof(glm::mat4),
+    };
+    palette.buffer = WOwned<WGPUBuffer>(wgpuDeviceCreateBuffer(device, &desc));
+    WMemoryTracker::TrackBuffer(palette.buffer.get(), desc, "WJointPalette");
+    return palette;
+}
+uint32_t WJointPalette::allocate(uint32_t count) {
+    if (used + count > joints.size()) {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Joint palette is full ({} joints)!", joints.size()).c_str());
+    }
+    uint32_t offset = used;
+    used += count;
+    return offset;
+}
+std::span<glm::mat4> WJointPalette::getJoints(uint32_t offset, uint32_t count) {
+    return std::span<glm::mat4>(joints).subspan(offset, count);
+}
+void WJointPalette::upload(WGPUQueue queue) {
+    if (used > 0) {
+        wgpuQueueWriteBuffer(queue, buffer.get(), 0, joints.data(), used * sizeof(glm::mat4));
+    }
+}
@@ -1,6 +1,43 @@
 #include <WCamera.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+WFrustum WFrustum::FromMatrix(const glm::mat4& viewProjection) {
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    // Gribb-Hartmann with a [0, 1] clip depth range, so the near plane is the third row alone.
+    WFrustum frustum;
+    frustum.m_Planes[0] = rows[3] + rows[0];
+    frustum.m_Planes[1] = rows[3] - rows[0];
+    frustum.m_Planes[2] = rows[3] + rows[1];
+    frustum.m_Planes[3] = rows[3] - rows[1];
+    frustum.m_Planes[4] = rows[2];
+    frustum.m_Planes[5] = rows[3] - rows[2];
+    for (glm::vec4& plane : frustum.m_Planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+bool WFrustum::intersectsSphere(glm::vec3 center, float radius) const {
+    for (const glm::vec4& plane : m_Planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+bool WFrustum::intersectsBox(glm::vec3 center, glm::vec3 extent) const {
+    for (const glm::vec4& plane : m_Planes) {
+        float radius = glm::dot(extent, glm::abs(glm::vec3(plane)));
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
 WCamera::WCamera() {
     m_WorldUp = WORLD_UP;
     m_Yaw = YAW;
@@ -19,6 +56,14 @@ WCamera& WCamera::withFront(glm::vec3 front) {
     m_Front = front;
     return *this;
 }
+void WCamera::lookAt(glm::vec3 position, glm::vec3 target) {
+    glm::vec3 direction = glm::normalize(target - position);
+    m_Position = position;
+    m_Pitch = glm::degrees(asin(glm::clamp(direction.y, -1.0f, 1.0f)));
+    m_Yaw = glm::degrees(atan2(direction.z, direction.x));
+
+    updateCameraVectors();
+}
 void WCamera::processCameraMovement(WCameraMovement direction, float dt) {
     float speed = m_MovementSpeed * dt;
     if (direction == WCameraMovement::FORWARD)
@@ -127,6 +172,9 @@ void WCameraManager::processMouseMovement(float xPos, float yPos, bool constrain
 void WCameraManager::processMouseScroll(float yOffset, float zoomMax, float zoomMin) {
     m_Camera.processMouseScroll(yOffset, zoomMax, zoomMin);
 }
+void WCameraManager::lookAt(glm::vec3 position, glm::vec3 target) {
+    m_Camera.lookAt(position, target);
+}
 void WCameraManager::setWorldUp(glm::vec3 worldUp) {
     m_Camera.setWorldUp(worldUp);
 }
@@ -164,3 +212,6 @@ glm::mat4 WCameraManager::getProjectionMatrix(float aspect) const {
 glm::mat4 WCameraManager::getViewMatrix() const {
     return m_Camera.getViewMatrix();
 }
+WFrustum WCameraManager::getFrustum(float aspect) const {
+    return WFrustum::FromMatrix(getProjectionMatrix(aspect) * getViewMatrix());
+}
@@ -2,28 +2,57 @@
 
 #include <WUtils.hpp>
 #include <WModel.hpp>
+#include <WProfiler.hpp>
+#include <WMipmapGenerator.hpp>
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <chrono>
+#include <ctime>
+#include <cstring>
+
+#ifdef WENGINE_PLATFORM_WINDOWS
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
 
 #include <glm/gtc/matrix_transform.hpp>
 
 WEngine *WEngine::engine = nullptr;
 
-void WEngine::Initialize() {
+static double processCpuSeconds() {
+#ifdef WENGINE_PLATFORM_WINDOWS
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    auto ticks = [](const FILETIME &time) { return ((uint64_t)time.dwHighDateTime << 32) | time.dwLowDateTime; };
+    return (ticks(kernel) + ticks(user)) * 1e-7;
+#else
+    timespec time{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
+
+void WEngine::Initialize(WEngineConfig engineConfig) {
     if (engine == nullptr) {
-        glfwInit();
+        if (!engineConfig.headless) {
+            glfwInit();
+        }
 
-        engine = new WEngine();
+        engine = new WEngine(engineConfig);
     }
 }
 
 void WEngine::Shutdown() {
     if (engine != nullptr) {
+        bool headless = engine->isHeadless();
         delete engine;
         engine = nullptr;
-        glfwTerminate();
+        if (!headless) {
+            glfwTerminate();
+        }
     }
 }
 
@@ -36,8 +65,15 @@ WEngine &WEngine::GetInstance() {
 }
 
 void WEngine::run() {
-    WGPUShaderModule shader = shaderFromWgslFile(device, "assets/shaders/shader.wgsl");
-    WGPUShaderModule modelShader = shaderFromWgslFile(device, "assets/shaders/model.wgsl");
+    WPROFILE_THREAD("Main");
+    WShaderLibrary shaderLibrary{device, "assets/shaders"};
+    std::string modelShaderPath = "assets/shaders/model.wgsl";
+    WShaderPermutation modelPermutation{};
+    if (engineConfig.compactVertices) {
+        modelPermutation.define("COMPACT_VERTICES");
+    }
+    WGPUShaderModule shader = shaderLibrary.load("assets/shaders/shader.wgsl");
+    WGPUShaderModule modelShader = shaderLibrary.load(modelShaderPath, modelPermutation);
 
     WGPUSampler sampler = WSamplerBuilder::New().build(device);
 
@@ -50,57 +86,135 @@ void WEngine::run() {
         .projection = camera.getProjectionMatrix((float)width / (float)height),
         .view = camera.getViewMatrix(),
     };
-    WUniformBuffer cameraBuffer = WUniformBuffer::New(device, &cameraData, sizeof(Camera));
-    WBindGroup globalGroup =
+    WOwned<WUniformBuffer> cameraBuffer{WUniformBuffer::New(device, &cameraData, sizeof(Camera))};
+    WOwned<WBindGroup> globalGroup{
         WBindGroupBuilder::New()
             .addBindingSampler(0, sampler)
-            .addBindingUniform(1, cameraBuffer)
-            .build(device);
-
-    WModel model =
-        WModelBuilder::New()
-            .setPath("assets/models/vanguard/punching.dae")
-            .setColorTarget(config.format)
-            .setGlobalBindGroup(globalGroup)
-            .setVertexShader(modelShader)
-            .setFragmentShader(modelShader)
-            .buildFromFile(device);
+            .addBindingUniform(1, cameraBuffer.get())
+            .build(device)};
+
+    WGeometryArena geometryArena = WGeometryArena::New();
+    WJointPalette jointPalette = WJointPalette::New(device, 16384);
+    WUniformAllocator uniformAllocator = WUniformAllocator::New(device, limits.minUniformBufferOffsetAlignment);
+
+    runStats = WEngineRunStats{};
+    auto loadStart = std::chrono::steady_clock::now();
+
+    std::vector<WModel> models;
+    models.reserve(engineConfig.models.size());
+    for (const std::string &path : engineConfig.models) {
+        models.push_back(WModelBuilder::New()
+                             .setPath(path)
+                             .setGeometryArena(&geometryArena)
+                             .setJointPalette(&jointPalette)
+                             .setUniformAllocator(&uniformAllocator)
+                             .setCompactVertices(engineConfig.compactVertices)
+                             .setInstanced(engineConfig.instanced)
+                             .setColorTarget(config.format)
+                             .setGlobalBindGroup(globalGroup.get())
+                             .setVertexShader(modelShader)
+                             .setFragmentShader(modelShader)
+                             .buildFromFile(device));
+    }
 
     modelData = glm::scale(modelData, glm::vec3(scale));
-    model.updateModel(queue, modelData);
+    for (WModel &model : models) {
+        model.updateModel(modelData);
+        shaderLibrary.subscribe(modelShaderPath, modelPermutation, [this, &model](WGPUShaderModule module) -> std::function<void()> {
+            WRenderPipeline pipeline = model.buildPipeline(device, module, module);
+            return [this, &model, pipeline]() { model.setPipeline(device, pipeline); };
+        });
+    }
+    printCacheReport();
+    WMemoryTracker::PrintReport();
+
+    WFrameSync frameSync = WFrameSync::New(device, queue, engineConfig.framesInFlight);
+    engineConfig.framesInFlight = frameSync.getFramesInFlight();
+    WGpuProfiler profiler = WGpuProfiler::New(device);
+
+    auto runStart = std::chrono::steady_clock::now();
+    runStats.loadMilliseconds = std::chrono::duration<double, std::milli>(runStart - loadStart).count();
+    double cpuStart = processCpuSeconds();
 
     float lastFrame = 0.0f;
-    while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
+    while (!shouldClose()) {
+        WPROFILE_SCOPE("Frame");
+        auto frameStart = std::chrono::steady_clock::now();
+        if (window != nullptr) {
+            WPROFILE_SCOPE("glfwPollEvents");
+            glfwPollEvents();
+        }
+        {
+            WPROFILE_SCOPE("WaitForFrame");
+            cpuWait = frameSync.beginFrame();
+            profiler.beginFrame(device);
+            deletionQueue.collect();
+        }
+        shaderLibrary.update();
 
-        float currentFrame = glfwGetTime();
-        dt = currentFrame - lastFrame;
+        float currentFrame = std::chrono::duration<float>(std::chrono::steady_clock::now() - runStart).count();
+        dt = engineConfig.fixedTimestep > 0.0f ? engineConfig.fixedTimestep : currentFrame - lastFrame;
         lastFrame = currentFrame;
 
         modelData = glm::scale(glm::mat4{1.0f}, glm::vec3(scale));
-        model.updateModel(queue, modelData);
-
-        if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS)
-            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-        if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS)
-            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-            camera.processCameraMovement(WCameraMovement::WORLD_FORWARD, dt);
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-            camera.processCameraMovement(WCameraMovement::WORLD_BACKWARD, dt);
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-            camera.processCameraMovement(WCameraMovement::RIGHT, dt);
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-            camera.processCameraMovement(WCameraMovement::LEFT, dt);
-        if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
-            camera.processCameraMovement(WCameraMovement::WORLD_DOWN, dt);
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
-            camera.processCameraMovement(WCameraMovement::WORLD_UP, dt);
+        for (WModel &model : models) {
+            model.updateModel(modelData);
+            model.updateAnimation(dt);
+        }
+        jointPalette.upload(queue);
+        uniformAllocator.upload(queue);
+
+        if (engineConfig.instanced && (instanceGrid != builtInstanceGrid || instanceSpacing != builtInstanceSpacing)) {
+            std::vector<WModelInstance> instances;
+            instances.reserve(instanceGrid * instanceGrid);
+            float half = (instanceGrid - 1) * instanceSpacing * 0.5f;
+            for (int32_t z = 0; z < instanceGrid; z++) {
+                for (int32_t x = 0; x < instanceGrid; x++) {
+                    instances.push_back(WModelInstance{
+                        .transform = glm::translate(glm::mat4{1.0f}, glm::vec3(x * instanceSpacing - half, 0.0f, z * instanceSpacing - half)),
+                        .tint = glm::vec4(1.0f),
+                    });
+                }
+            }
+            for (WModel &model : models) {
+                model.setInstances(device, instances);
+            }
+            builtInstanceGrid = instanceGrid;
+            builtInstanceSpacing = instanceSpacing;
+        }
+
+        WTextureCache::Update(device);
+        for (WModel &model : models) {
+            model.refreshTextures(device);
+        }
+
+        if (window != nullptr) {
+            if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS)
+                glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+            if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS)
+                glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+
+            if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+                camera.processCameraMovement(WCameraMovement::WORLD_FORWARD, dt);
+            if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+                camera.processCameraMovement(WCameraMovement::WORLD_BACKWARD, dt);
+            if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+                camera.processCameraMovement(WCameraMovement::RIGHT, dt);
+            if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+                camera.processCameraMovement(WCameraMovement::LEFT, dt);
+            if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+                camera.processCameraMovement(WCameraMovement::WORLD_DOWN, dt);
+            if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+                camera.processCameraMovement(WCameraMovement::WORLD_UP, dt);
+        }
+
+        if (engineConfig.cameraPath) {
+            engineConfig.cameraPath(runStats.frames, camera);
+        }
 
         cameraData.projection = camera.getProjectionMatrix((float)width / (float)height);
         cameraData.view = camera.getViewMatrix();
-        cameraBuffer.update(queue, &cameraData);
+        cameraBuffer->update(queue, &cameraData);
 
         presentFrame([&](WGPUTextureView frame) {
             WGPUCommandEncoder commandEncoder = wgpuDeviceCreateCommandEncoder(device, nullptr);
@@ -109,33 +223,103 @@ void WEngine::run() {
             WGPURenderPassEncoder encoder =
                 WRenderPassBuilder::New()
                     .addColorTarget(WColorAttachment::New(frame).setClearColor(0.2, 0.3, 0.3, 1.0))
-                    .setDepthAttachment(WDepthStencilAttachment::New(depthTexture))
+                    .setDepthAttachment(WDepthStencilAttachment::New(depthTexture.get()))
+                    .setTimestampWrites(profiler.passTimestamps("scene"))
                     .build(commandEncoder);
-            model.render(encoder);
+            {
+                WPROFILE_SCOPE("EncodeScene");
+                WFrustum frustum = camera.getFrustum((float)width / (float)height);
+                float pixelsPerUnit = cameraData.projection[1][1] * height * 0.5f;
+                cullStats = WModelCullStats{};
+                for (WModel &model : models) {
+                    model.render(encoder, frustum);
+                    if (engineConfig.textureStreaming) {
+                        model.requestTextures(frustum, camera.getCamera().getPosition(), pixelsPerUnit);
+                    }
+                    cullStats.visible += model.getCullStats().visible;
+                    cullStats.culled += model.getCullStats().culled;
+                    runStats.instances += (uint64_t)model.getCullStats().visible * model.getInstanceCount();
+                }
+                runStats.draws += cullStats.visible;
+                runStats.culled += cullStats.culled;
+                wgpuRenderPassEncoderEnd(encoder);
+            }
 
-            updateImGui(encoder);
-            wgpuRenderPassEncoderEnd(encoder);
+            if (!isHeadless()) {
+                WGPURenderPassEncoder imguiEncoder =
+                    WRenderPassBuilder::New()
+                        .addColorTarget(WColorAttachment::New(frame).setLoadOp(WGPULoadOp_Load))
+                        .setDepthAttachment(WDepthStencilAttachment::New(depthTexture.get()).setLoadOp(WGPULoadOp_Load))
+                        .setTimestampWrites(profiler.passTimestamps("imgui"))
+                        .build(commandEncoder, "ImGui Pass Encoder");
+                updateImGui(imguiEncoder, profiler);
+                wgpuRenderPassEncoderEnd(imguiEncoder);
+            }
+            profiler.resolve(commandEncoder);
 
             commandBuffers.push_back(wgpuCommandEncoderFinish(commandEncoder, nullptr));
-            wgpuQueueSubmit(queue, commandBuffers.size(), commandBuffers.data());
+            WPROFILE_SCOPE("Submit");
+            frameSync.endFrame(wgpuQueueSubmitForIndex(queue, commandBuffers.size(), commandBuffers.data()));
+            deletionQueue.submit();
+            profiler.endFrame();
             for (const WGPUCommandBuffer &commandBuffer : commandBuffers) {
                 wgpuCommandBufferRelease(commandBuffer);
             }
             wgpuCommandEncoderRelease(commandEncoder);
         });
+
+        if (runStats.frames == 0) {
+            wgpuDevicePoll(device, true, nullptr);
+            runStats.firstFrameMilliseconds =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+        }
+        runStats.frameMilliseconds.push_back(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        runStats.frames++;
     }
+
+    runStats.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+    runStats.cpuSeconds = processCpuSeconds() - cpuStart;
+    runStats.memory = WMemoryTracker::GetTotal();
+    fmt::println("[WEngine]::[INFO]: Rendered {} frames in {:.2f} s: {:.1f} frames/s, {:.1f} frames per CPU-second",
+                 runStats.frames, runStats.wallSeconds, runStats.framesPerSecond(), runStats.framesPerCpuSecond());
+
+#ifdef WENGINE_PROFILE
+    WProfiler::WriteChromeTrace("trace.json");
+#endif
 }
 
-WEngine::WEngine() {
+WEngine::WEngine(WEngineConfig engineConfig)
+    : engineConfig(engineConfig),
+      title(engineConfig.title),
+      width(engineConfig.width),
+      height(engineConfig.height),
+      instanceGrid(engineConfig.instanceGrid) {
     // setupLogging();
 
-    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
-    glfwSetWindowUserPointer(window, this);
-    glfwSetKeyCallback(window, glfwKeyCallback);
-    glfwSetFramebufferSizeCallback(window, glfwFramebuffersizeCallback);
-    glfwSetCursorPosCallback(window, glfwCursorPosCallback);
-    glfwSetScrollCallback(window, glfwScrollCallabck);
+    if (engineConfig.headless && engineConfig.maxFrames == 0) {
+        throw std::exception("[WEngine]::[ERROR]: A headless engine needs 'maxFrames' to be set!");
+    }
+
+    WMemoryTracker::SetBudget(engineConfig.memoryBudget, [callback = engineConfig.onMemoryBudgetExceeded](const WMemoryBudgetEvent &event) {
+        fmt::println("[WEngine]::[WARN]: GPU memory budget exceeded: {:.2f} of {:.2f} MiB after a {} allocation by '{}'",
+                     event.totalBytes / 1048576.0, event.budgetBytes / 1048576.0,
+                     WMemoryTracker::CategoryName(event.category), event.owner);
+        WTextureCache::Evict(event.totalBytes - event.budgetBytes);
+        if (callback) {
+            callback(event);
+        }
+    });
+
+    if (!engineConfig.headless) {
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+        glfwSetWindowUserPointer(window, this);
+        glfwSetKeyCallback(window, glfwKeyCallback);
+        glfwSetFramebufferSizeCallback(window, glfwFramebuffersizeCallback);
+        glfwSetCursorPosCallback(window, glfwCursorPosCallback);
+        glfwSetScrollCallback(window, glfwScrollCallabck);
+    }
 
     WGPUInstanceExtras instanceExtras{
         .chain = WGPUChainedStruct{
@@ -151,8 +335,13 @@ WEngine::WEngine() {
 #endif
     instance = wgpuCreateInstance(&instanceDescriptor);
 
-    surface = glfwGetWGPUSurface(window, instance);
-    WGPURequestAdapterOptions adapterOptions{.compatibleSurface = surface};
+    if (window != nullptr) {
+        surface = glfwGetWGPUSurface(window, instance);
+    }
+    WGPURequestAdapterOptions adapterOptions{
+        .compatibleSurface = surface,
+        .forceFallbackAdapter = engineConfig.forceFallbackAdapter,
+    };
     wgpuInstanceRequestAdapter(
         instance,
         &adapterOptions,
@@ -168,9 +357,23 @@ WEngine::WEngine() {
             }
         },
         &this->adapter);
+    std::vector<WGPUFeatureName> features;
+    if (wgpuAdapterHasFeature(adapter, WGPUFeatureName_TextureCompressionBC)) {
+        features.push_back(WGPUFeatureName_TextureCompressionBC);
+    }
+    WGPUAdapterProperties adapterProperties{};
+    wgpuAdapterGetProperties(adapter, &adapterProperties);
+    if (wgpuAdapterHasFeature(adapter, WGPUFeatureName_TimestampQuery) &&
+        adapterProperties.adapterType != WGPUAdapterType_CPU) {
+        features.push_back(WGPUFeatureName_TimestampQuery);
+    }
+    WGPUDeviceDescriptor deviceDesc{
+        .requiredFeatureCount = features.size(),
+        .requiredFeatures = features.data(),
+    };
     wgpuAdapterRequestDevice(
         adapter,
-        nullptr,
+        &deviceDesc,
         [](WGPURequestDeviceStatus status, WGPUDevice device, const char *message, void *userdata) {
             switch (status) {
                 case WGPURequestDeviceStatus_Success: {
@@ -184,51 +387,148 @@ WEngine::WEngine() {
         },
         &this->device);
     queue = wgpuDeviceGetQueue(device);
-    WGPUSurfaceCapabilities caps{};
-    wgpuSurfaceGetCapabilities(surface, adapter, &caps);
     config = WGPUSurfaceConfiguration{
         .device = device,
         .format = WGPUTextureFormat_RGBA8UnormSrgb,
         .usage = WGPUTextureUsage_RenderAttachment,
         .viewFormatCount = 0,
         .viewFormats = nullptr,
-        .alphaMode = caps.alphaModes[0],
         .width = width,
         .height = height,
-        .presentMode = caps.presentModes[0],
     };
 #ifdef WENGINE_PLATFORM_WINDOWS
     config.format = WGPUTextureFormat_RGBA8Unorm;
 #endif
-    for (uint32_t i = 0; i < caps.presentModeCount; i++) {
-        if (WGPUPresentMode_Mailbox == caps.presentModes[i]) {
-            config.presentMode = WGPUPresentMode_Mailbox;
-            break;
+    if (surface != nullptr) {
+        WGPUSurfaceCapabilities caps{};
+        wgpuSurfaceGetCapabilities(surface, adapter, &caps);
+        config.alphaMode = caps.alphaModes[0];
+        config.presentMode = caps.presentModes[0];
+        for (uint32_t i = 0; i < caps.presentModeCount; i++) {
+            if (WGPUPresentMode_Mailbox == caps.presentModes[i]) {
+                config.presentMode = WGPUPresentMode_Mailbox;
+                break;
+            }
         }
+        wgpuSurfaceConfigure(surface, &config);
+        wgpuSurfaceCapabilitiesFreeMembers(caps);
+    } else {
+        WMemoryScope memoryScope{"WEngine"};
+        offscreenTexture = WOwned<WTexture>(
+            WTextureBuilder::New()
+                .setFormat(config.format)
+                .setTextureUsages(WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_CopySrc)
+                .build(device, WGPUExtent3D{.width = width, .height = height, .depthOrArrayLayers = 1}));
+        fmt::println("[WEngine]::[INFO]: Running headless at {}x{} for {} frames", width, height, engineConfig.maxFrames);
     }
-    wgpuSurfaceConfigure(surface, &config);
-    wgpuSurfaceCapabilitiesFreeMembers(caps);
 
     WGPUSupportedLimits supportedLimits{};
     wgpuDeviceGetLimits(device, &supportedLimits);
     limits = supportedLimits.limits;
 
-    depthTexture = WTexture::GetDepthTexture(device, width, height);
+    deletionQueue = WDeletionQueue::New(queue);
+    WTextureCache::SetDeletionQueue(&deletionQueue);
+    WTextureCache::SetStreaming(engineConfig.textureStreaming);
+    WTextureCache::SetBudget(engineConfig.textureBudget);
+    resizeDepthTexture(width, height);
 
-    initImGui();
+    if (window != nullptr) {
+        initImGui();
+    }
+}
+
+std::vector<unsigned char> WEngine::readFrame() {
+    if (!isHeadless()) {
+        throw std::exception("[WEngine]::[ERROR]: Frames can only be read back from a headless engine!");
+    }
+
+    uint32_t rowSize = width * 4;
+    uint32_t bytesPerRow = (rowSize + 255) & ~255u;
+    WGPUBufferDescriptor readbackDesc{
+        .label = "Frame Readback",
+        .usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst,
+        .size = (uint64_t)bytesPerRow * height,
+    };
+    WGPUBuffer readback = wgpuDeviceCreateBuffer(device, &readbackDesc);
+
+    WGPUImageCopyTexture source{
+        .texture = offscreenTexture.get(),
+        .mipLevel = 0,
+        .origin = WGPUOrigin3D{0, 0, 0},
+        .aspect = WGPUTextureAspect_All,
+    };
+    WGPUImageCopyBuffer destination{
+        .layout = WGPUTextureDataLayout{
+            .offset = 0,
+            .bytesPerRow = bytesPerRow,
+            .rowsPerImage = height,
+        },
+        .buffer = readback,
+    };
+    WGPUExtent3D size{.width = width, .height = height, .depthOrArrayLayers = 1};
+    WGPUCommandEncoder commandEncoder = wgpuDeviceCreateCommandEncoder(device, nullptr);
+    wgpuCommandEncoderCopyTextureToBuffer(commandEncoder, &source, &destination, &size);
+    WGPUCommandBuffer commandBuffer = wgpuCommandEncoderFinish(commandEncoder, nullptr);
+    wgpuQueueSubmit(queue, 1, &commandBuffer);
+    wgpuCommandBufferRelease(commandBuffer);
+    wgpuCommandEncoderRelease(commandEncoder);
+
+    struct MapResult {
+        bool done = false;
+        WGPUBufferMapAsyncStatus status = WGPUBufferMapAsyncStatus_Unknown;
+    } result;
+    wgpuBufferMapAsync(
+        readback, WGPUMapMode_Read, 0, readbackDesc.size,
+        [](WGPUBufferMapAsyncStatus status, void *userdata) {
+            MapResult *result = (MapResult *)userdata;
+            result->status = status;
+            result->done = true;
+        },
+        &result);
+    while (!result.done) {
+        wgpuDevicePoll(device, true, nullptr);
+    }
+    if (result.status != WGPUBufferMapAsyncStatus_Success) {
+        wgpuBufferRelease(readback);
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Failed to map frame readback: status={}", (uint32_t)result.status).c_str());
+    }
+
+    std::vector<unsigned char> pixels((size_t)rowSize * height);
+    const unsigned char *mapped = (const unsigned char *)wgpuBufferGetConstMappedRange(readback, 0, readbackDesc.size);
+    for (uint32_t y = 0; y < height; y++) {
+        std::memcpy(pixels.data() + (size_t)y * rowSize, mapped + (size_t)y * bytesPerRow, rowSize);
+    }
+    wgpuBufferUnmap(readback);
+    wgpuBufferRelease(readback);
+    return pixels;
 }
 
 WEngine::~WEngine() {
-    shutdownImGui();
+    if (window != nullptr) {
+        shutdownImGui();
+    }
+
+    depthTexture.reset();
+    offscreenTexture.reset();
+    WTextureCache::Clear();
+    WTextureCache::SetDeletionQueue(nullptr);
+    deletionQueue.flush(device);
+    WMipmapGenerator::Clear(device);
+    WPipelineCache::Clear(device);
+    checkLeaks();
 
     wgpuQueueRelease(queue);
     wgpuDeviceRelease(device);
     wgpuAdapterRelease(adapter);
-    wgpuSurfaceRelease(surface);
+    if (surface != nullptr) {
+        wgpuSurfaceRelease(surface);
+    }
     wgpuInstanceRelease(instance);
 
-    glfwDestroyWindow(window);
-    window = nullptr;
+    if (window != nullptr) {
+        glfwDestroyWindow(window);
+        window = nullptr;
+    }
 }
 
 void WEngine::initImGui() {
@@ -250,7 +550,8 @@ void WEngine::shutdownImGui() {
     ImGui_ImplWGPU_Shutdown();
 }
 
-void WEngine::updateImGui(WGPURenderPassEncoder encoder) {
+void WEngine::updateImGui(WGPURenderPassEncoder encoder, const WGpuProfiler &profiler) {
+    WPROFILE_FUNCTION();
     ImGui_ImplWGPU_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
@@ -258,6 +559,47 @@ void WEngine::updateImGui(WGPURenderPassEncoder encoder) {
     if (ImGui::Begin("Scale the model")) {
         ImGui::SliderFloat("Scale", &scale, 1.0f / 50.0f, 1.0f);
         ImGui::Text("FPS: %d, ms: %f", (uint32_t)(1.0f/dt), dt);
+        ImGui::Text("CPU wait for GPU: %.3f ms (%u frames in flight)", cpuWait, engineConfig.framesInFlight);
+        ImGui::Text("Meshes: %u visible, %u culled", cullStats.visible, cullStats.culled);
+        ImGui::SliderInt("Instances per side", &instanceGrid, 1, 100);
+        ImGui::SliderFloat("Instance spacing", &instanceSpacing, 10.0f, 500.0f);
+        if (profiler.isSupported()) {
+            for (const auto &[name, timing] : profiler.getTimings()) {
+                ImGui::Text("GPU %s: %.3f ms (last %.3f ms)", name.c_str(), timing.average(), timing.last);
+            }
+        } else {
+            ImGui::Text("GPU timestamps unavailable");
+        }
+
+        WMemoryStats memory = WMemoryTracker::GetTotal();
+        if (WMemoryTracker::GetBudget() != 0) {
+            ImGui::Text("GPU memory: %.2f / %.2f MiB (peak %.2f MiB)", memory.bytes / 1048576.0,
+                        WMemoryTracker::GetBudget() / 1048576.0, memory.peakBytes / 1048576.0);
+        } else {
+            ImGui::Text("GPU memory: %.2f MiB (peak %.2f MiB)", memory.bytes / 1048576.0, memory.peakBytes / 1048576.0);
+        }
+        WTextureStreamingStats streaming = WTextureCache::GetStats();
+        if (streaming.budget != 0) {
+            ImGui::Text("Textures: %.2f / %.2f MiB in %u resident, %u uploads, %u evictions", streaming.residentBytes / 1048576.0,
+                        streaming.budget / 1048576.0, streaming.textures, streaming.uploads, streaming.evictions);
+        } else {
+            ImGui::Text("Textures: %.2f MiB in %u resident, %u uploads, %u evictions", streaming.residentBytes / 1048576.0,
+                        streaming.textures, streaming.uploads, streaming.evictions);
+        }
+        if (ImGui::TreeNode("GPU memory by category")) {
+            for (uint32_t i = 0; i < (uint32_t)WMemoryCategory::Count; i++) {
+                WMemoryStats category = WMemoryTracker::GetCategory((WMemoryCategory)i);
+                ImGui::Text("%s: %.2f MiB (peak %.2f MiB, %u allocations)", WMemoryTracker::CategoryName((WMemoryCategory)i),
+                            category.bytes / 1048576.0, category.peakBytes / 1048576.0, category.allocations);
+            }
+            ImGui::TreePop();
+        }
+        if (ImGui::TreeNode("GPU memory by owner")) {
+            for (const auto &[owner, bytes] : WMemoryTracker::GetOwners()) {
+                ImGui::Text("%s: %.2f MiB", owner.c_str(), bytes / 1048576.0);
+            }
+            ImGui::TreePop();
+        }
 
         ImGui::End();
     }
@@ -267,7 +609,26 @@ void WEngine::updateImGui(WGPURenderPassEncoder encoder) {
     ImGui_ImplWGPU_RenderDrawData(ImGui::GetDrawData(), encoder);
 }
 
+void WEngine::resizeDepthTexture(uint32_t width, uint32_t height) {
+    WMemoryScope memoryScope{"WEngine"};
+    deletionQueue.retire(std::move(depthTexture));
+    depthTexture = WOwned<WTexture>(WTexture::GetDepthTexture(device, width, height));
+}
+
+bool WEngine::shouldClose() const {
+    if (engineConfig.maxFrames != 0 && runStats.frames >= engineConfig.maxFrames) {
+        return true;
+    }
+    return window != nullptr && glfwWindowShouldClose(window);
+}
+
 void WEngine::presentFrame(std::function<void(WGPUTextureView)> frame) {
+    WPROFILE_FUNCTION();
+    if (surface == nullptr) {
+        frame((WGPUTextureView)offscreenTexture.get());
+        return;
+    }
+
     bool skip = false;
     WGPUSurfaceTexture surfaceTexture;
     wgpuSurfaceGetCurrentTexture(surface, &surfaceTexture);
@@ -283,14 +644,14 @@ void WEngine::presentFrame(std::function<void(WGPUTextureView)> frame) {
             int width, height;
             glfwGetWindowSize(window, &width, &height);
             if (width != 0 && height != 0) {
-                config.width = width;
-                config.height = height;
-                depthTexture = WTexture::GetDepthTexture(device, config.width, config.height);
+                this->width = config.width = width;
+                this->height = config.height = height;
+                resizeDepthTexture(config.width, config.height);
                 wgpuSurfaceConfigure(surface, &config);
             }
             std::cout << "[WEngine]::[INFO]: Resizing in the main function!" << std::endl;
             skip = true;
-        }
+        } break;
         case WGPUSurfaceGetCurrentTextureStatus_OutOfMemory:
         case WGPUSurfaceGetCurrentTextureStatus_DeviceLost:
         case WGPUSurfaceGetCurrentTextureStatus_Force32:
@@ -300,7 +661,10 @@ void WEngine::presentFrame(std::function<void(WGPUTextureView)> frame) {
     if (!skip) {
         WGPUTextureView target = wgpuTextureCreateView(surfaceTexture.texture, nullptr);
         frame(target);
-        wgpuSurfacePresent(surface);
+        {
+            WPROFILE_SCOPE("wgpuSurfacePresent");
+            wgpuSurfacePresent(surface);
+        }
 
         wgpuTextureViewRelease(target);
         wgpuTextureRelease(surfaceTexture.texture);
@@ -367,6 +731,66 @@ void WEngine::printWGPUReport() const {
     }
 
     fmt::println("--------------------------------------------------------------------------------------------");
+    printCacheReport();
+    WMemoryTracker::PrintReport();
+}
+
+WGPUHubReport WEngine::generateHubReport() const {
+    WGPUGlobalReport report{};
+    wgpuGenerateReport(instance, &report);
+
+    switch (report.backendType) {
+        case WGPUBackendType_D3D12:
+            return report.dx12;
+        case WGPUBackendType_Metal:
+            return report.metal;
+        case WGPUBackendType_Vulkan:
+            return report.vulkan;
+        case WGPUBackendType_OpenGLES:
+        case WGPUBackendType_OpenGL:
+            return report.gl;
+        default:
+            return WGPUHubReport{};
+    }
+}
+
+void WEngine::printCacheReport() const {
+    WGPUHubReport hub = generateHubReport();
+
+    auto print = [](const char *name, const WGPURegistryReport &registry, const WCacheStats &stats) {
+        fmt::println("[WEngine]::[INFO]: {}: {} allocated, {} cached, {} creation(s) saved by the cache",
+                     name, registry.numAllocated, stats.size, stats.hits);
+    };
+    print("renderPipelines", hub.renderPipelines, WPipelineCache::GetStats());
+    print("pipelineLayouts", hub.pipelineLayouts, WPipelineCache::GetPipelineLayoutStats());
+    print("bindGroupLayouts", hub.bindGroupLayouts, WPipelineCache::GetBindGroupLayoutStats());
+    print("samplers", hub.samplers, WPipelineCache::GetSamplerStats());
+}
+
+void WEngine::checkLeaks() const {
+    WGPUHubReport hub = generateHubReport();
+
+    uint64_t leaked = 0;
+    auto check = [&](const char *name, const WGPURegistryReport &registry) {
+        if (registry.numKeptFromUser > 0) {
+            fmt::println("[WEngine]::[WARN]: Leak check: {} {} still held at shutdown", registry.numKeptFromUser, name);
+            leaked += registry.numKeptFromUser;
+        }
+    };
+    check("shaderModules", hub.shaderModules);
+    check("renderPipelines", hub.renderPipelines);
+    check("pipelineLayouts", hub.pipelineLayouts);
+    check("bindGroupLayouts", hub.bindGroupLayouts);
+    check("bindGroups", hub.bindGroups);
+    check("renderBundles", hub.renderBundles);
+    check("querySets", hub.querySets);
+    check("textures", hub.textures);
+    check("textureViews", hub.textureViews);
+    check("samplers", hub.samplers);
+    check("buffers", hub.buffers);
+    if (leaked == 0) {
+        fmt::println("[WEngine]::[INFO]: Leak check: no GPU objects outstanding at shutdown");
+    }
 }
 
 void WEngine::glfwKeyCallback(GLFWwindow *window, int32_t key, int32_t scancode, int32_t action, int32_t mods) {
@@ -378,6 +802,12 @@ void WEngine::glfwKeyCallback(GLFWwindow *window, int32_t key, int32_t scancode,
         WEngine *engine = (WEngine *)glfwGetWindowUserPointer(window);
         engine->printWGPUReport();
     }
+
+#ifdef WENGINE_PROFILE
+    if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+        WProfiler::WriteChromeTrace("trace.json");
+    }
+#endif
 }
 
 void WEngine::glfwFramebuffersizeCallback(GLFWwindow *window, int32_t width, int32_t height) {
@@ -392,7 +822,7 @@ void WEngine::glfwFramebuffersizeCallback(GLFWwindow *window, int32_t width, int
     engine.config.width = width;
     engine.config.height = height;
 
-    engine.depthTexture = WTexture::GetDepthTexture(engine.device, engine.width, engine.height);
+    engine.resizeDepthTexture(engine.width, engine.height);
     wgpuSurfaceConfigure(engine.surface, &engine.config);
 }
 
@@ -429,29 +859,3 @@ void WEngine::wgpuLogCallback(WGPULogLevel level, const char *message, void *use
     }
     fmt::println("{}{}", levelStr, message);
 }
-
-WGPUShaderModule WEngine::shaderFromWgslFile(WGPUDevice device, std::string path) {
-    std::ifstream file{path};
-
-    if (!file.is_open()) {
-        throw std::exception(fmt::format("[WEngine]::[ERROR]: Failed to open shader file from path: {}", path).c_str());
-    }
-    std::stringstream shaderStream;
-    shaderStream << file.rdbuf();
-    file.close();
-
-    std::string shaderCode = shaderStream.str();
-
-    WGPUShaderModuleWGSLDescriptor wgslDescriptor{
-        .chain = WGPUChainedStruct{
-            .sType = WGPUSType_ShaderModuleWGSLDescriptor,
-        },
-        .code = shaderCode.c_str(),
-    };
-    WGPUShaderModuleDescriptor shaderDescriptor{
-        .nextInChain = (const WGPUChainedStruct *)&wgslDescriptor,
-        .label = path.c_str(),
-    };
-
-    return wgpuDeviceCreateShaderModule(device, &shaderDescriptor);
-}
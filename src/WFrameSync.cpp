@@ -0,0 +1,53 @@
+#include <WFrameSync.hpp>
+
+#include <chrono>
+#include <algorithm>
+
+WFrameSync WFrameSync::New(WGPUDevice device, WGPUQueue queue, uint32_t framesInFlight) {
+    WFrameSync sync;
+    sync.device = device;
+    sync.queue = queue;
+    sync.framesInFlight = std::clamp(framesInFlight, 1u, 3u);
+    for (uint32_t i = 0; i < sync.framesInFlight; i++) {
+        sync.slots.push_back(std::make_unique<Slot>());
+    }
+    return sync;
+}
+WFrameSync::~WFrameSync() {
+    waitIdle();
+}
+double WFrameSync::beginFrame() {
+    auto start = std::chrono::steady_clock::now();
+    wait(*slots[getFrameIndex()]);
+    waitMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return waitMilliseconds;
+}
+void WFrameSync::endFrame(WGPUSubmissionIndex submission) {
+    Slot &slot = *slots[getFrameIndex()];
+    slot.submission = submission;
+    slot.pending = true;
+    wgpuQueueOnSubmittedWorkDone(
+        queue,
+        [](WGPUQueueWorkDoneStatus status, void *userdata) {
+            ((Slot *)userdata)->pending = false;
+        },
+        &slot);
+    frame++;
+}
+void WFrameSync::waitIdle() {
+    for (std::unique_ptr<Slot> &slot : slots) {
+        wait(*slot);
+    }
+}
+void WFrameSync::wait(Slot &slot) {
+    if (!slot.pending) {
+        return;
+    }
+    WGPUWrappedSubmissionIndex wrapped{
+        .queue = queue,
+        .submissionIndex = slot.submission,
+    };
+    while (slot.pending) {
+        wgpuDevicePoll(device, true, &wrapped);
+    }
+}
@@ -0,0 +1,212 @@
+#include <WGeometryArena.hpp>
+
+#include <WUtils.hpp>
+#include <WMemoryTracker.hpp>
+
+#include <algorithm>
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+WFreeList WFreeList::New(uint64_t capacity) {
+    WFreeList list;
+    list.capacity = capacity;
+    if (capacity > 0) {
+        list.blocks[0] = capacity;
+    }
+    return list;
+}
+std::optional<uint64_t> WFreeList::allocate(uint64_t size, uint64_t alignment) {
+    auto best = blocks.end();
+    uint64_t bestOffset = 0;
+    for (auto it = blocks.begin(); it != blocks.end(); it++) {
+        uint64_t offset = alignUp(it->first, alignment);
+        uint64_t end = it->first + it->second;
+        if (offset + size > end) {
+            continue;
+        }
+        if (best == blocks.end() || it->second < best->second) {
+            best = it;
+            bestOffset = offset;
+        }
+    }
+    if (best == blocks.end()) {
+        return std::nullopt;
+    }
+
+    uint64_t blockOffset = best->first;
+    uint64_t blockEnd = best->first + best->second;
+    blocks.erase(best);
+    if (bestOffset > blockOffset) {
+        blocks[blockOffset] = bestOffset - blockOffset;
+    }
+    if (bestOffset + size < blockEnd) {
+        blocks[bestOffset + size] = blockEnd - bestOffset - size;
+    }
+    used += size;
+    return bestOffset;
+}
+void WFreeList::free(uint64_t offset, uint64_t size) {
+    used -= size;
+
+    auto next = blocks.lower_bound(offset);
+    if (next != blocks.end() && offset + size == next->first) {
+        size += next->second;
+        next = blocks.erase(next);
+    }
+    if (next != blocks.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+    blocks[offset] = size;
+}
+uint64_t WFreeList::getLargestFreeBlock() const {
+    uint64_t largest = 0;
+    for (const auto &[offset, size] : blocks) {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
+
+WGeometryArena WGeometryArena::New(uint64_t vertexPageSize, uint64_t indexPageSize) {
+    WGeometryArena arena;
+    arena.vertexPageSize = vertexPageSize;
+    arena.indexPageSize = indexPageSize;
+    return arena;
+}
+WRenderBuffer WGeometryArena::allocate(WGPUDevice device,
+                                       const void *vertices,
+                                       size_t verticesCount,
+                                       uint32_t vertexStride,
+                                       const uint32_t *indices,
+                                       size_t indicesCount) {
+    bool narrow = WRenderBufferBuilder::CanNarrowIndices(verticesCount);
+    WGPUIndexFormat indexFormat = narrow ? WGPUIndexFormat_Uint16 : WGPUIndexFormat_Uint32;
+    size_t indexSize = WRenderBuffer::IndexSize(indexFormat);
+    uint64_t indexBytes = alignUp(indicesCount * indexSize, 4);
+
+    std::vector<uint16_t> narrowIndices;
+    const void *indexData = indices;
+    if (narrow) {
+        narrowIndices = WRenderBufferBuilder::NarrowIndices({indices, indicesCount});
+        narrowIndices.resize(indexBytes / sizeof(uint16_t), 0);
+        indexData = narrowIndices.data();
+    }
+
+    Page *page = nullptr;
+    std::optional<uint64_t> vertexOffset;
+    std::optional<uint64_t> indexOffset;
+    for (Page &candidate : pages) {
+        if (candidate.vertexStride != vertexStride) {
+            continue;
+        }
+        vertexOffset = candidate.vertexFree.allocate(verticesCount);
+        if (!vertexOffset) {
+            continue;
+        }
+        indexOffset = candidate.indexFree.allocate(indexBytes, 4);
+        if (!indexOffset) {
+            candidate.vertexFree.free(*vertexOffset, verticesCount);
+            continue;
+        }
+        page = &candidate;
+        break;
+    }
+    if (page == nullptr) {
+        page = &addPage(device, vertexStride, verticesCount, indexBytes);
+        vertexOffset = page->vertexFree.allocate(verticesCount);
+        indexOffset = page->indexFree.allocate(indexBytes, 4);
+    }
+
+    WGPUQueue queue = wgpuDeviceGetQueue(device);
+    wgpuQueueWriteBuffer(queue, page->vertex.get(), *vertexOffset * vertexStride, vertices, verticesCount * vertexStride);
+    wgpuQueueWriteBuffer(queue, page->index.get(), *indexOffset, indexData, indexBytes);
+    wgpuQueueRelease(queue);
+    allocationCount++;
+
+    return WRenderBuffer::New(page->vertex.get(),
+                              page->index.get(),
+                              verticesCount * vertexStride,
+                              verticesCount,
+                              indicesCount,
+                              *vertexOffset,
+                              *indexOffset / indexSize,
+                              indexFormat);
+}
+void WGeometryArena::free(const WRenderBuffer &renderBuffer) {
+    for (Page &page : pages) {
+        if (page.vertex.get() != renderBuffer.getVertexBuffer()) {
+            continue;
+        }
+        page.vertexFree.free(renderBuffer.getBaseVertex(), renderBuffer.getVerticesCount());
+        page.indexFree.free(renderBuffer.getFirstIndex() * WRenderBuffer::IndexSize(renderBuffer.getIndexFormat()),
+                            alignUp(renderBuffer.getIndicesSize(), 4));
+        allocationCount--;
+        return;
+    }
+    throw std::exception("[WEngine]::[ERROR]: Render buffer was not allocated from this geometry arena!");
+}
+WGeometryArenaStats WGeometryArena::getStats() const {
+    WGeometryArenaStats stats{
+        .pageCount = (uint32_t)pages.size(),
+        .allocationCount = allocationCount,
+    };
+
+    uint64_t vertexFree = 0, vertexLargest = 0;
+    uint64_t indexFree = 0, indexLargest = 0;
+    for (const Page &page : pages) {
+        stats.vertexCapacity += page.vertexFree.getCapacity() * page.vertexStride;
+        stats.vertexUsed += page.vertexFree.getUsed() * page.vertexStride;
+        stats.indexCapacity += page.indexFree.getCapacity();
+        stats.indexUsed += page.indexFree.getUsed();
+        stats.freeBlockCount += page.vertexFree.getFreeBlockCount() + page.indexFree.getFreeBlockCount();
+
+        vertexFree += (page.vertexFree.getCapacity() - page.vertexFree.getUsed()) * page.vertexStride;
+        vertexLargest = std::max(vertexLargest, page.vertexFree.getLargestFreeBlock() * page.vertexStride);
+        indexFree += page.indexFree.getCapacity() - page.indexFree.getUsed();
+        indexLargest = std::max(indexLargest, page.indexFree.getLargestFreeBlock());
+    }
+    stats.vertexFragmentation = vertexFree == 0 ? 0.0f : 1.0f - (float)vertexLargest / vertexFree;
+    stats.indexFragmentation = indexFree == 0 ? 0.0f : 1.0f - (float)indexLargest / indexFree;
+    return stats;
+}
+void WGeometryArena::printStats() const {
+    WGeometryArenaStats stats = getStats();
+    fmt::println("[WEngine]::[INFO]: Geometry arena: {} allocation(s) in {} page(s), vertex {:.2f}/{:.2f} MiB, index {:.2f}/{:.2f} MiB, "
+                 "{} free block(s), fragmentation vertex {:.1f}% index {:.1f}%",
+                 stats.allocationCount, stats.pageCount,
+                 stats.vertexUsed / 1048576.0, stats.vertexCapacity / 1048576.0,
+                 stats.indexUsed / 1048576.0, stats.indexCapacity / 1048576.0,
+                 stats.freeBlockCount,
+                 stats.vertexFragmentation * 100.0f, stats.indexFragmentation * 100.0f);
+}
+WGeometryArena::Page &WGeometryArena::addPage(WGPUDevice device, uint32_t vertexStride, uint64_t vertexCount, uint64_t indexBytes) {
+    uint64_t vertexCapacity = std::max(vertexPageSize / vertexStride, vertexCount);
+    uint64_t indexCapacity = std::max(alignUp(indexPageSize, 4), indexBytes);
+
+    WGPUBufferDescriptor vertexDesc{
+        .label = "Geometry Arena Vertex Buffer",
+        .usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst,
+        .size = vertexCapacity * vertexStride,
+    };
+    WGPUBufferDescriptor indexDesc{
+        .label = "Geometry Arena Index Buffer",
+        .usage = WGPUBufferUsage_Index | WGPUBufferUsage_CopyDst,
+        .size = indexCapacity,
+    };
+
+    pages.push_back(Page{
+        .vertexStride = vertexStride,
+        .vertex = WOwned<WGPUBuffer>(wgpuDeviceCreateBuffer(device, &vertexDesc)),
+        .index = WOwned<WGPUBuffer>(wgpuDeviceCreateBuffer(device, &indexDesc)),
+        .vertexFree = WFreeList::New(vertexCapacity),
+        .indexFree = WFreeList::New(indexCapacity),
+    });
+    WMemoryTracker::TrackBuffer(pages.back().vertex.get(), vertexDesc, "WGeometryArena");
+    WMemoryTracker::TrackBuffer(pages.back().index.get(), indexDesc, "WGeometryArena");
+    return pages.back();
+}
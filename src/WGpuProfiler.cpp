@@ -0,0 +1,183 @@
+#include <WGpuProfiler.hpp>
+#include <WResource.hpp>
+
+void WGpuTiming::add(double milliseconds) {
+    samples[next] = milliseconds;
+    next = (next + 1) % WINDOW;
+    count = std::min(count + 1, WINDOW);
+    last = milliseconds;
+}
+double WGpuTiming::average() const {
+    double sum = 0.0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    return count == 0 ? 0.0 : sum / count;
+}
+
+WGpuProfiler WGpuProfiler::New(WGPUDevice device, uint32_t maxScopes, uint32_t latency) {
+    WGpuProfiler profiler;
+    if (!wgpuDeviceHasFeature(device, WGPUFeatureName_TimestampQuery)) {
+        fmt::println("[WEngine]::[INFO]: Timestamp queries are not supported, GPU profiling is disabled");
+        return profiler;
+    }
+
+    profiler.device = device;
+    profiler.maxScopes = maxScopes;
+    WGPUQuerySetDescriptor queryDesc{
+        .label = "GPU Profiler Queries",
+        .type = WGPUQueryType_Timestamp,
+        .count = maxScopes * 2,
+    };
+    profiler.querySet = wgpuDeviceCreateQuerySet(device, &queryDesc);
+
+    WGPUBufferDescriptor resolveDesc{
+        .label = "GPU Profiler Resolve",
+        .usage = WGPUBufferUsage_QueryResolve | WGPUBufferUsage_CopySrc,
+        .size = maxScopes * 2 * sizeof(uint64_t),
+    };
+    profiler.resolveBuffer = wgpuDeviceCreateBuffer(device, &resolveDesc);
+
+    for (uint32_t i = 0; i < latency; i++) {
+        WGPUBufferDescriptor readbackDesc{
+            .label = "GPU Profiler Readback",
+            .usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst,
+            .size = maxScopes * 2 * sizeof(uint64_t),
+        };
+        profiler.slots.push_back(std::make_unique<Slot>());
+        profiler.slots.back()->readback = wgpuDeviceCreateBuffer(device, &readbackDesc);
+    }
+    profiler.passWrites.reserve(maxScopes);
+    return profiler;
+}
+WGpuProfiler::WGpuProfiler(WGpuProfiler &&other) noexcept {
+    *this = std::move(other);
+}
+WGpuProfiler &WGpuProfiler::operator=(WGpuProfiler &&other) noexcept {
+    if (this != &other) {
+        std::swap(device, other.device);
+        std::swap(querySet, other.querySet);
+        std::swap(resolveBuffer, other.resolveBuffer);
+        std::swap(slots, other.slots);
+        std::swap(passWrites, other.passWrites);
+        std::swap(timings, other.timings);
+        std::swap(maxScopes, other.maxScopes);
+        std::swap(frame, other.frame);
+        std::swap(current, other.current);
+        std::swap(timestampPeriod, other.timestampPeriod);
+    }
+    return *this;
+}
+WGpuProfiler::~WGpuProfiler() {
+    if (!isSupported()) {
+        return;
+    }
+
+    for (std::unique_ptr<Slot> &slot : slots) {
+        while (slot->state == SlotState::Mapping) {
+            wgpuDevicePoll(device, true, nullptr);
+        }
+        if (slot->state == SlotState::Ready) {
+            wgpuBufferUnmap(slot->readback);
+        }
+        WRelease(slot->readback);
+    }
+    WRelease(resolveBuffer);
+    WRelease(querySet);
+}
+void WGpuProfiler::beginFrame(WGPUDevice device) {
+    current = nullptr;
+    if (!isSupported()) {
+        return;
+    }
+
+    wgpuDevicePoll(device, false, nullptr);
+    for (std::unique_ptr<Slot> &slot : slots) {
+        if (slot->state == SlotState::Ready) {
+            collect(*slot);
+        }
+    }
+
+    Slot &slot = *slots[frame % slots.size()];
+    if (slot.state != SlotState::Idle) {
+        return;
+    }
+    slot.names.clear();
+    slot.queryCount = 0;
+    slot.state = SlotState::Recording;
+    passWrites.clear();
+    current = &slot;
+}
+const WGPURenderPassTimestampWrites *WGpuProfiler::passTimestamps(const std::string &name) {
+    uint32_t scope = allocateScope(name);
+    if (scope == UINT32_MAX) {
+        return nullptr;
+    }
+    passWrites.push_back(WGPURenderPassTimestampWrites{
+        .querySet = querySet,
+        .beginningOfPassWriteIndex = scope * 2,
+        .endOfPassWriteIndex = scope * 2 + 1,
+    });
+    return &passWrites.back();
+}
+void WGpuProfiler::resolve(WGPUCommandEncoder encoder) {
+    if (current == nullptr || current->queryCount == 0) {
+        return;
+    }
+    wgpuCommandEncoderResolveQuerySet(encoder, querySet, 0, current->queryCount, resolveBuffer, 0);
+    wgpuCommandEncoderCopyBufferToBuffer(encoder, resolveBuffer, 0, current->readback, 0,
+                                         current->queryCount * sizeof(uint64_t));
+    current->state = SlotState::Resolved;
+}
+void WGpuProfiler::endFrame() {
+    frame++;
+    if (current == nullptr) {
+        return;
+    }
+    if (current->state != SlotState::Resolved) {
+        current->state = SlotState::Idle;
+        current = nullptr;
+        return;
+    }
+
+    current->state = SlotState::Mapping;
+    wgpuBufferMapAsync(
+        current->readback, WGPUMapMode_Read, 0, current->queryCount * sizeof(uint64_t),
+        [](WGPUBufferMapAsyncStatus status, void *userdata) {
+            Slot *slot = (Slot *)userdata;
+            slot->state = status == WGPUBufferMapAsyncStatus_Success ? SlotState::Ready : SlotState::Idle;
+        },
+        current);
+    current = nullptr;
+}
+void WGpuProfiler::setTimestampPeriod(double nanosecondsPerTick) {
+    timestampPeriod = nanosecondsPerTick;
+}
+double WGpuProfiler::getAverage(const std::string &name) const {
+    auto found = timings.find(name);
+    return found == timings.end() ? 0.0 : found->second.average();
+}
+uint32_t WGpuProfiler::allocateScope(const std::string &name) {
+    if (current == nullptr || current->queryCount + 2 > maxScopes * 2) {
+        return UINT32_MAX;
+    }
+    uint32_t scope = current->queryCount / 2;
+    current->queryCount += 2;
+    current->names.push_back(name);
+    return scope;
+}
+void WGpuProfiler::collect(Slot &slot) {
+    const uint64_t *ticks =
+        (const uint64_t *)wgpuBufferGetConstMappedRange(slot.readback, 0, slot.queryCount * sizeof(uint64_t));
+    if (ticks != nullptr) {
+        for (uint32_t i = 0; i < slot.names.size(); i++) {
+            uint64_t begin = ticks[i * 2];
+            uint64_t end = ticks[i * 2 + 1];
+            if (end >= begin) {
+                timings[slot.names[i]].add((end - begin) * timestampPeriod / 1e6);
+            }
+        }
+    }
+    wgpuBufferUnmap(slot.readback);
+    slot.state = SlotState::Idle;
+}
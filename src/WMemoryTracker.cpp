@@ -0,0 +1,225 @@
+#include <WMemoryTracker.hpp>
+
+#include <algorithm>
+
+std::mutex WMemoryTracker::mutex{};
+std::unordered_map<const void *, WMemoryTracker::Allocation> WMemoryTracker::allocations{};
+std::array<WMemoryStats, (size_t)WMemoryCategory::Count> WMemoryTracker::categories{};
+WMemoryStats WMemoryTracker::total{};
+uint64_t WMemoryTracker::budget = 0;
+bool WMemoryTracker::overBudget = false;
+WMemoryBudgetCallback WMemoryTracker::budgetCallback{};
+thread_local std::string WMemoryTracker::currentOwner{};
+
+namespace {
+struct FormatInfo {
+    uint32_t blockSize;
+    uint32_t blockBytes;
+};
+
+FormatInfo formatInfo(WGPUTextureFormat format) {
+    switch (format) {
+        case WGPUTextureFormat_R8Unorm:
+        case WGPUTextureFormat_Stencil8:
+            return {1, 1};
+        case WGPUTextureFormat_RG8Unorm:
+        case WGPUTextureFormat_R16Float:
+        case WGPUTextureFormat_Depth16Unorm:
+            return {1, 2};
+        case WGPUTextureFormat_RG16Float:
+        case WGPUTextureFormat_RGBA8Unorm:
+        case WGPUTextureFormat_RGBA8UnormSrgb:
+        case WGPUTextureFormat_BGRA8Unorm:
+        case WGPUTextureFormat_BGRA8UnormSrgb:
+        case WGPUTextureFormat_R32Float:
+        case WGPUTextureFormat_Depth24Plus:
+        case WGPUTextureFormat_Depth24PlusStencil8:
+        case WGPUTextureFormat_Depth32Float:
+            return {1, 4};
+        case WGPUTextureFormat_RGBA16Float:
+        case WGPUTextureFormat_Depth32FloatStencil8:
+            return {1, 8};
+        case WGPUTextureFormat_RGBA32Float:
+            return {1, 16};
+        case WGPUTextureFormat_BC1RGBAUnorm:
+        case WGPUTextureFormat_BC1RGBAUnormSrgb:
+        case WGPUTextureFormat_BC4RUnorm:
+        case WGPUTextureFormat_BC4RSnorm:
+            return {4, 8};
+        case WGPUTextureFormat_BC2RGBAUnorm:
+        case WGPUTextureFormat_BC2RGBAUnormSrgb:
+        case WGPUTextureFormat_BC3RGBAUnorm:
+        case WGPUTextureFormat_BC3RGBAUnormSrgb:
+        case WGPUTextureFormat_BC5RGUnorm:
+        case WGPUTextureFormat_BC5RGSnorm:
+        case WGPUTextureFormat_BC6HRGBUfloat:
+        case WGPUTextureFormat_BC6HRGBFloat:
+        case WGPUTextureFormat_BC7RGBAUnorm:
+        case WGPUTextureFormat_BC7RGBAUnormSrgb:
+            return {4, 16};
+        default:
+            return {1, 4};
+    }
+}
+
+bool isDepthFormat(WGPUTextureFormat format) {
+    return format == WGPUTextureFormat_Stencil8 || format == WGPUTextureFormat_Depth16Unorm ||
+           format == WGPUTextureFormat_Depth24Plus || format == WGPUTextureFormat_Depth24PlusStencil8 ||
+           format == WGPUTextureFormat_Depth32Float || format == WGPUTextureFormat_Depth32FloatStencil8;
+}
+}  // namespace
+
+void WMemoryTracker::TrackBuffer(WGPUBuffer buffer, const WGPUBufferDescriptor &desc, const std::string &owner) {
+    WMemoryCategory category = WMemoryCategory::Other;
+    if (desc.usage & WGPUBufferUsage_Index) {
+        category = WMemoryCategory::Index;
+    } else if (desc.usage & WGPUBufferUsage_Vertex) {
+        category = WMemoryCategory::Vertex;
+    } else if (desc.usage & WGPUBufferUsage_Uniform) {
+        category = WMemoryCategory::Uniform;
+    } else if (desc.usage & WGPUBufferUsage_Storage) {
+        category = WMemoryCategory::Storage;
+    } else if (desc.usage & (WGPUBufferUsage_MapRead | WGPUBufferUsage_MapWrite)) {
+        category = WMemoryCategory::Staging;
+    }
+    Track(buffer, category, desc.size, owner);
+}
+void WMemoryTracker::TrackTexture(WGPUTexture texture, const WGPUTextureDescriptor &desc, const std::string &owner) {
+    bool attachment = isDepthFormat(desc.format) ||
+                      ((desc.usage & WGPUTextureUsage_RenderAttachment) && !(desc.usage & WGPUTextureUsage_TextureBinding));
+    Track(texture, attachment ? WMemoryCategory::Attachment : WMemoryCategory::Texture, TextureBytes(desc), owner);
+}
+void WMemoryTracker::Track(const void *handle, WMemoryCategory category, uint64_t bytes, const std::string &owner) {
+    if (handle == nullptr) {
+        return;
+    }
+
+    WMemoryBudgetEvent event{};
+    WMemoryBudgetCallback callback;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        Allocation allocation{
+            .category = category,
+            .bytes = bytes,
+            .owner = !owner.empty() ? owner : !currentOwner.empty() ? currentOwner : "unowned",
+        };
+
+        WMemoryStats &stats = categories[(size_t)category];
+        stats.bytes += bytes;
+        stats.peakBytes = std::max(stats.peakBytes, stats.bytes);
+        stats.allocations++;
+        total.bytes += bytes;
+        total.peakBytes = std::max(total.peakBytes, total.bytes);
+        total.allocations++;
+
+        if (budget != 0 && total.bytes > budget && !overBudget) {
+            overBudget = true;
+            callback = budgetCallback;
+            event = WMemoryBudgetEvent{total.bytes, budget, category, allocation.owner};
+        }
+        allocations[handle] = std::move(allocation);
+    }
+
+    if (callback) {
+        callback(event);
+    }
+}
+void WMemoryTracker::Untrack(const void *handle) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto found = allocations.find(handle);
+    if (found == allocations.end()) {
+        return;
+    }
+
+    WMemoryStats &stats = categories[(size_t)found->second.category];
+    stats.bytes -= found->second.bytes;
+    stats.allocations--;
+    total.bytes -= found->second.bytes;
+    total.allocations--;
+    allocations.erase(found);
+
+    if (total.bytes <= budget) {
+        overBudget = false;
+    }
+}
+void WMemoryTracker::SetBudget(uint64_t bytes, WMemoryBudgetCallback callback) {
+    std::lock_guard<std::mutex> lock{mutex};
+    budget = bytes;
+    budgetCallback = std::move(callback);
+    overBudget = false;
+}
+WMemoryStats WMemoryTracker::GetTotal() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return total;
+}
+WMemoryStats WMemoryTracker::GetCategory(WMemoryCategory category) {
+    std::lock_guard<std::mutex> lock{mutex};
+    return categories[(size_t)category];
+}
+std::vector<std::pair<std::string, uint64_t>> WMemoryTracker::GetOwners() {
+    std::map<std::string, uint64_t> owners;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (const auto &[handle, allocation] : allocations) {
+            owners[allocation.owner] += allocation.bytes;
+        }
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> sorted(owners.begin(), owners.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+    return sorted;
+}
+const char *WMemoryTracker::CategoryName(WMemoryCategory category) {
+    switch (category) {
+        case WMemoryCategory::Texture:
+            return "Textures";
+        case WMemoryCategory::Attachment:
+            return "Attachments";
+        case WMemoryCategory::Vertex:
+            return "Vertex buffers";
+        case WMemoryCategory::Index:
+            return "Index buffers";
+        case WMemoryCategory::Uniform:
+            return "Uniform buffers";
+        case WMemoryCategory::Storage:
+            return "Storage buffers";
+        case WMemoryCategory::Staging:
+            return "Staging buffers";
+        default:
+            return "Other";
+    }
+}
+uint64_t WMemoryTracker::TextureBytes(const WGPUTextureDescriptor &desc) {
+    FormatInfo info = formatInfo(desc.format);
+    uint64_t bytes = 0;
+    for (uint32_t level = 0; level < std::max(1u, desc.mipLevelCount); level++) {
+        uint64_t width = std::max(1u, desc.size.width >> level);
+        uint64_t height = std::max(1u, desc.size.height >> level);
+        uint64_t blocksWide = (width + info.blockSize - 1) / info.blockSize;
+        uint64_t blocksHigh = (height + info.blockSize - 1) / info.blockSize;
+        bytes += blocksWide * blocksHigh * info.blockBytes;
+    }
+    return bytes * std::max(1u, desc.size.depthOrArrayLayers) * std::max(1u, desc.sampleCount);
+}
+void WMemoryTracker::PrintReport() {
+    WMemoryStats stats = GetTotal();
+    fmt::println("[WEngine]::[INFO]: GPU memory: {:.2f} MiB in {} allocation(s), peak {:.2f} MiB", stats.bytes / 1048576.0,
+                 stats.allocations, stats.peakBytes / 1048576.0);
+    for (uint32_t i = 0; i < (uint32_t)WMemoryCategory::Count; i++) {
+        WMemoryStats category = GetCategory((WMemoryCategory)i);
+        if (category.peakBytes > 0) {
+            fmt::println("[WEngine]::[INFO]:   {}: {:.2f} MiB (peak {:.2f} MiB)", CategoryName((WMemoryCategory)i),
+                         category.bytes / 1048576.0, category.peakBytes / 1048576.0);
+        }
+    }
+    for (const auto &[owner, bytes] : GetOwners()) {
+        fmt::println("[WEngine]::[INFO]:   {}: {:.2f} MiB", owner, bytes / 1048576.0);
+    }
+}
+
+WMemoryScope::WMemoryScope(std::string owner) : previous(std::move(WMemoryTracker::currentOwner)) {
+    WMemoryTracker::currentOwner = std::move(owner);
+}
+WMemoryScope::~WMemoryScope() {
+    WMemoryTracker::currentOwner = std::move(previous);
+}
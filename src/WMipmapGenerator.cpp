@@ -0,0 +1,179 @@
+#include <WMipmapGenerator.hpp>
+
+#include <WUtils.hpp>
+#include <WPipelineCache.hpp>
+
+#include <bit>
+#include <algorithm>
+
+static const char *MIPMAP_SHADER = R"(
+struct VertexOut {
+    @builtin(position) position: vec4<f32>,
+    @location(0) uv: vec2<f32>,
+}
+
+@group(0) @binding(0)
+var sampler2d: sampler;
+@group(0) @binding(1)
+var source: texture_2d<f32>;
+
+@vertex
+fn vs_main(@builtin(vertex_index) index: u32) -> VertexOut {
+    let uv = vec2<f32>(f32((index << 1u) & 2u), f32(index & 2u));
+    var out: VertexOut;
+    out.position = vec4<f32>(uv * vec2<f32>(2.0, -2.0) + vec2<f32>(-1.0, 1.0), 0.0, 1.0);
+    out.uv = uv;
+    return out;
+}
+
+@fragment
+fn fs_main(in: VertexOut) -> @location(0) vec4<f32> {
+    return textureSample(source, sampler2d, in.uv);
+}
+)";
+
+std::vector<WMipmapGenerator::Request> WMipmapGenerator::pending = std::vector<WMipmapGenerator::Request>{};
+std::map<WGPUTextureFormat, WGPURenderPipeline> WMipmapGenerator::pipelines = std::map<WGPUTextureFormat, WGPURenderPipeline>{};
+WGPUShaderModule WMipmapGenerator::shader = nullptr;
+WGPUSampler WMipmapGenerator::sampler = nullptr;
+WGPUBindGroupLayout WMipmapGenerator::layout = nullptr;
+uint32_t WMipmapGenerator::batchDepth = 0;
+
+uint32_t WMipmapGenerator::MipLevelCount(WGPUExtent3D size) {
+    return std::bit_width(std::max({size.width, size.height, 1u}));
+}
+void WMipmapGenerator::Generate(WGPUDevice device, WGPUTexture texture, WGPUTextureDescriptor desc) {
+    if (desc.mipLevelCount <= 1) {
+        return;
+    }
+    if (desc.dimension != WGPUTextureDimension_2D || !(desc.usage & WGPUTextureUsage_RenderAttachment)) {
+        throw std::exception("[WEngine]::[ERROR]: Mipmaps can only be generated for 2D textures with render attachment usage!");
+    }
+
+    wgpuTextureReference(texture);
+    pending.push_back(Request{.texture = texture, .desc = desc});
+    if (batchDepth == 0) {
+        Flush(device);
+    }
+}
+void WMipmapGenerator::BeginBatch() {
+    batchDepth++;
+}
+void WMipmapGenerator::EndBatch(WGPUDevice device) {
+    if (batchDepth > 0 && --batchDepth == 0) {
+        Flush(device);
+    }
+}
+void WMipmapGenerator::Flush(WGPUDevice device) {
+    if (pending.empty()) {
+        return;
+    }
+
+    std::vector<WGPUTextureView> views;
+    std::vector<WGPUBindGroup> bindGroups;
+    WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(device, nullptr);
+    for (const Request &request : pending) {
+        WGPURenderPipeline pipeline = GetPipeline(device, request.desc.format);
+        for (uint32_t layer = 0; layer < request.desc.size.depthOrArrayLayers; layer++) {
+            WGPUTextureViewDescriptor viewDesc{
+                .format = request.desc.format,
+                .dimension = WGPUTextureViewDimension_2D,
+                .baseMipLevel = 0,
+                .mipLevelCount = 1,
+                .baseArrayLayer = layer,
+                .arrayLayerCount = 1,
+                .aspect = WGPUTextureAspect_All,
+            };
+            WGPUTextureView source = wgpuTextureCreateView(request.texture, &viewDesc);
+            views.push_back(source);
+
+            for (uint32_t level = 1; level < request.desc.mipLevelCount; level++) {
+                viewDesc.baseMipLevel = level;
+                WGPUTextureView target = wgpuTextureCreateView(request.texture, &viewDesc);
+                views.push_back(target);
+
+                WGPUBindGroup bindGroup = WBindGroupBuilder::New()
+                                              .addBindingSampler(0, sampler)
+                                              .addBindingTexture(1, source)
+                                              .buildBindGroup(device, layout);
+                bindGroups.push_back(bindGroup);
+
+                WGPURenderPassEncoder pass = WRenderPassBuilder::New()
+                                                 .addColorTarget(WColorAttachment::New(target))
+                                                 .build(encoder, "Mipmap Pass Encoder");
+                wgpuRenderPassEncoderSetPipeline(pass, pipeline);
+                wgpuRenderPassEncoderSetBindGroup(pass, 0, bindGroup, 0, nullptr);
+                wgpuRenderPassEncoderDraw(pass, 3, 1, 0, 0);
+                wgpuRenderPassEncoderEnd(pass);
+                wgpuRenderPassEncoderRelease(pass);
+
+                source = target;
+            }
+        }
+    }
+
+    WGPUCommandBuffer commands = wgpuCommandEncoderFinish(encoder, nullptr);
+    WGPUQueue queue = wgpuDeviceGetQueue(device);
+    wgpuQueueSubmit(queue, 1, &commands);
+    wgpuQueueRelease(queue);
+    wgpuCommandBufferRelease(commands);
+    wgpuCommandEncoderRelease(encoder);
+
+    for (WGPUBindGroup bindGroup : bindGroups) {
+        wgpuBindGroupRelease(bindGroup);
+    }
+    for (WGPUTextureView view : views) {
+        wgpuTextureViewRelease(view);
+    }
+    for (const Request &request : pending) {
+        wgpuTextureRelease(request.texture);
+    }
+    pending.clear();
+}
+void WMipmapGenerator::Clear(WGPUDevice device) {
+    pipelines.clear();
+    if (shader != nullptr) {
+        WPipelineCache::EvictShader(device, shader);
+        wgpuShaderModuleRelease(shader);
+        shader = nullptr;
+    }
+    sampler = nullptr;
+    layout = nullptr;
+}
+WGPURenderPipeline WMipmapGenerator::GetPipeline(WGPUDevice device, WGPUTextureFormat format) {
+    auto found = pipelines.find(format);
+    if (found != pipelines.end()) {
+        return found->second;
+    }
+
+    if (shader == nullptr) {
+        WGPUShaderModuleWGSLDescriptor wgslDescriptor{
+            .chain = WGPUChainedStruct{
+                .sType = WGPUSType_ShaderModuleWGSLDescriptor,
+            },
+            .code = MIPMAP_SHADER,
+        };
+        WGPUShaderModuleDescriptor shaderDescriptor{
+            .nextInChain = (const WGPUChainedStruct *)&wgslDescriptor,
+            .label = "Mipmap Shader",
+        };
+        shader = wgpuDeviceCreateShaderModule(device, &shaderDescriptor);
+        sampler = WSamplerBuilder::New()
+                      .setAddressMode(WGPUAddressMode_ClampToEdge)
+                      .setMipmapFilter(WGPUMipmapFilterMode_Nearest)
+                      .build(device);
+        layout = WBindGroupLayoutBuilder::New()
+                     .addBindingSampler(0)
+                     .addBindingTexture(1)
+                     .build(device);
+    }
+
+    WRenderPipeline pipeline = WRenderPipelineBuilder::New()
+                                   .addBindGroupLayout(layout)
+                                   .addColorTarget(format)
+                                   .setVertexState(shader)
+                                   .setFragmentState(shader)
+                                   .build(device);
+    pipelines[format] = pipeline;
+    return pipeline;
+}
@@ -1,8 +1,16 @@
 #include <WModel.hpp>
 
 #include <WUtils.hpp>
+#include <WModelCache.hpp>
+#include <WThreadPool.hpp>
+#include <WMipmapGenerator.hpp>
+#include <WProfiler.hpp>
+#include <WMemoryTracker.hpp>
+#include <WResource.hpp>
 
 #include <filesystem>
+#include <chrono>
+#include <algorithm>
 
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
@@ -15,33 +23,62 @@
 #include <glm/vec3.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/mat4x4.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <meshoptimizer.h>
+
+#include <cmath>
+#include <bit>
+#include <limits>
 
 namespace fs = std::filesystem;
 
-void processNode(WGPUDevice device,
-                 std::vector<WMesh> &meshes,
-                 WGPUTextureFormat colorTargetFormat,
-                 WBindGroup globalGroup,
-                 WGPUBindGroupLayout localBindGroupLayout,
-                 WUniformBuffer modelBuffer,
-                 WRenderPipeline pipeline,
-                 const std::string &directory,
+struct WMeshCacheStats {
+    uint64_t triangles = 0;
+    uint64_t vertices = 0;
+    uint64_t verticesAfter = 0;
+    uint64_t transformedBefore = 0;
+    uint64_t transformedAfter = 0;
+
+    inline float acmr(uint64_t transformed) const { return triangles == 0 ? 0.0f : (float)transformed / triangles; }
+    inline static float atvr(uint64_t transformed, uint64_t count) { return count == 0 ? 0.0f : (float)transformed / count; }
+};
+
+static constexpr uint32_t OPTIMIZE_VERTEX_CACHE = 1 << 0;
+static constexpr uint32_t OPTIMIZE_OVERDRAW = 1 << 1;
+static constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+struct WSceneGraph {
+    std::vector<const aiMesh *> meshes;
+    std::vector<uint32_t> meshNodes;
+    std::map<std::string, uint32_t> nodeIndices;
+    WSkeleton skeleton;
+};
+
+void processNode(WSceneGraph &graph,
                  const aiNode *node,
+                 int32_t parent,
                  const aiScene *scene);
-WMesh processMesh(WGPUDevice device,
-                  WGPUTextureFormat colorTargetFormat,
-                  WBindGroup globalGroup,
-                  WGPUBindGroupLayout localBindGroupLayout,
-                  WUniformBuffer modelBuffer,
-                  WRenderPipeline pipeline,
-                  const std::string &directory,
-                  const aiMesh *mesh,
-                  const aiScene *scene);
-WTexture loadMaterialTextures(WGPUDevice device,
-                              aiTextureType type,
-                              const std::string directory,
-                              const aiMaterial *material,
-                              const aiScene *scene);
+std::vector<uint32_t> processSkeleton(WSceneGraph &graph, const aiScene *scene);
+WImportedMesh processMesh(const aiMesh *mesh, const uint32_t *jointBase);
+WMeshCacheStats optimizeMesh(WImportedMesh &mesh, bool overdraw);
+WImportedMaterial processMaterial(aiTextureType type,
+                                  const aiMaterial *material,
+                                  const aiScene *scene);
+WMesh createMesh(WGPUDevice device,
+                 WGeometryArena *geometryArena,
+                 WGPUBindGroupLayout localBindGroupLayout,
+                 WUniformAllocator *uniformAllocator,
+                 WUniformSlice modelSlice,
+                 WJointPalette *palette,
+                 const WSkeleton *skeleton,
+                 const std::string &directory,
+                 const WMeshData &mesh,
+                 const WMaterialData &material,
+                 WModelCompactError *compactError);
+std::string loadMaterialTextures(WGPUDevice device,
+                                 const std::string directory,
+                                 const WMaterialData &material);
 
 class AssimpToGlm {
    public:
@@ -78,38 +115,300 @@ class AssimpToGlm {
     }
 };
 
-class WTextureCache {
-   public:
-    static WTexture New(WGPUDevice device, std::string path) {
-        if (cache.find(path) == cache.end()) {
-            WTexture texture = WTexture::fromFileAsRgba8(device, path, false);
-            cache[path] = texture;
-            return texture;
-        } else {
-            return cache[path];
+static WThreadPool &textureDecodePool() {
+    static WThreadPool pool{std::max(1u, WThreadPool::HardwareThreads() - 1)};
+    return pool;
+}
+
+std::map<std::string, WTextureCache::Entry> WTextureCache::cache = std::map<std::string, WTextureCache::Entry>{};
+std::optional<WTexture> WTextureCache::placeholder = std::nullopt;
+uint64_t WTextureCache::generation = 0;
+uint64_t WTextureCache::frame = 0;
+bool WTextureCache::streaming = false;
+uint64_t WTextureCache::budget = 0;
+uint64_t WTextureCache::pendingEviction = 0;
+bool WTextureCache::pressured = false;
+WDeletionQueue *WTextureCache::deletionQueue = nullptr;
+WTextureStreamingStats WTextureCache::stats{};
+
+WTexture WTextureCache::New(WGPUDevice device, std::string path, std::string fallback) {
+    if (fs::path(path).extension() == ".ktx2") {
+        bool allowBC = wgpuDeviceHasFeature(device, WGPUFeatureName_TextureCompressionBC);
+        return Schedule(device, path, [path, fallback, allowBC]() {
+            try {
+                return WImage::fromKtx2File(path, allowBC);
+            } catch (const std::exception &) {
+                if (fallback.empty() || !fs::exists(fallback)) {
+                    throw;
+                }
+                fmt::println("[WEngine]::[WARN]: KTX2 texture '{}' is not usable on this adapter, loading '{}' instead", path, fallback);
+                return WImage::fromFileAsRgba8(fallback, false);
+            }
+        });
+    }
+    return Schedule(device, path, [path]() {
+        return WImage::fromFileAsRgba8(path, false);
+    });
+}
+WTexture WTextureCache::New(WGPUDevice device, std::string path, const void *data, size_t size) {
+    std::vector<unsigned char> bytes((const unsigned char *)data, (const unsigned char *)data + size);
+    return Schedule(device, path, [bytes = std::move(bytes)]() {
+        return WImage::fromMemoryAsRgba8(bytes.data(), bytes.size(), false);
+    });
+}
+WTexture WTextureCache::New(WGPUDevice device, std::string path, const void *pixels, uint32_t width, uint32_t height) {
+    std::vector<unsigned char> bytes((const unsigned char *)pixels, (const unsigned char *)pixels + (size_t)width * height * 4);
+    return Schedule(device, path, [bytes = std::move(bytes), width, height]() {
+        return WImage::fromRgba8(bytes.data(), width, height);
+    });
+}
+void WTextureCache::RemoveTexture(std::string path) {
+    auto found = cache.find(path);
+    if (found == cache.end()) {
+        return;
+    }
+    Retire(found->second);
+    cache.erase(found);
+}
+const WTexture &WTextureCache::GetTexture(std::string path) {
+    return cache[path].texture;
+}
+void WTextureCache::Request(const std::string &path, float pixels) {
+    auto found = cache.find(path);
+    if (found == cache.end()) {
+        return;
+    }
+    found->second.requestedPixels = std::max(found->second.requestedPixels, pixels);
+    found->second.lastUsed = frame;
+}
+void WTextureCache::SetStreaming(bool enabled) {
+    streaming = enabled;
+}
+void WTextureCache::SetBudget(uint64_t bytes) {
+    budget = bytes;
+}
+void WTextureCache::Evict(uint64_t bytes) {
+    pendingEviction += bytes;
+}
+void WTextureCache::SetDeletionQueue(WDeletionQueue *deletionQueue) {
+    WTextureCache::deletionQueue = deletionQueue;
+}
+bool WTextureCache::Update(WGPUDevice device) {
+    WPROFILE_FUNCTION();
+    uint64_t previousGeneration = generation;
+    WMipmapGenerator::BeginBatch();
+    for (auto &[path, entry] : cache) {
+        if (entry.pending.valid() && entry.pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            Upload(device, path, entry);
         }
     }
-    static WTexture New(WGPUDevice device, std::string path, void *data, size_t size) {
-        if (cache.find(path) == cache.end()) {
-            WTexture texture = WTexture::fromMemoryAsRgba8(device, data, size, false);
-            cache[path] = texture;
-            return texture;
-        } else {
-            return cache[path];
+
+    std::vector<Entry *> streamed;
+    for (auto &[path, entry] : cache) {
+        if (entry.image && entry.residentLevel != NotResident) {
+            streamed.push_back(&entry);
         }
     }
-    static void RemoveTexture(std::string path) {
-        cache.erase(cache.find(path));
+
+    if (pressured && (WMemoryTracker::GetBudget() == 0 || (budget != 0 && Limit() >= budget))) {
+        pressured = false;
+        fmt::println("[WEngine]::[INFO]: GPU memory pressure relieved, texture budget restored");
     }
-    static const WTexture &GetTexture(std::string path) {
-        return cache[path];
+    uint64_t limit = Limit();
+    if (pendingEviction > 0 || (limit != 0 && stats.residentBytes > limit)) {
+        std::sort(streamed.begin(), streamed.end(), [](const Entry *a, const Entry *b) { return a->lastUsed < b->lastUsed; });
+        uint64_t target = stats.residentBytes > pendingEviction ? stats.residentBytes - pendingEviction : 0;
+        if (limit != 0) {
+            target = std::min(target, limit);
+        }
+        for (Entry *entry : streamed) {
+            uint32_t lowest = StartLevel(*entry->image);
+            if (stats.residentBytes <= target || entry->residentLevel >= lowest) {
+                continue;
+            }
+            uint32_t level = entry->residentLevel;
+            while (level < lowest && stats.residentBytes - entry->residentBytes + LevelBytes(*entry->image, level) > target) {
+                level++;
+            }
+            MakeResident(device, *entry, level);
+            stats.evictions++;
+        }
+        if (pendingEviction > 0) {
+            fmt::println("[WEngine]::[WARN]: Evicted textures down to {:.2f} MiB to relieve GPU memory pressure",
+                         stats.residentBytes / 1048576.0);
+            pendingEviction = 0;
+            pressured = true;
+            limit = Limit();
+        }
     }
 
-   private:
-    static std::map<std::string, WTexture> cache;
-};
+    std::sort(streamed.begin(), streamed.end(), [](const Entry *a, const Entry *b) { return a->requestedPixels > b->requestedPixels; });
+    uint32_t uploads = 0;
+    for (Entry *entry : streamed) {
+        uint32_t desired = DesiredLevel(*entry);
+        if (uploads == MaxUploadsPerUpdate) {
+            break;
+        }
+        if (desired >= entry->residentLevel) {
+            continue;
+        }
+        uint32_t level = desired;
+        while (level < entry->residentLevel && limit != 0 &&
+               stats.residentBytes - entry->residentBytes + LevelBytes(*entry->image, level) > limit) {
+            level++;
+        }
+        if (level < entry->residentLevel) {
+            MakeResident(device, *entry, level);
+            uploads++;
+        }
+    }
+    WMipmapGenerator::EndBatch(device);
 
-std::map<std::string, WTexture> WTextureCache::cache = std::map<std::string, WTexture>{};
+    for (auto &[path, entry] : cache) {
+        entry.requestedPixels = 0.0f;
+    }
+    frame++;
+    return generation != previousGeneration;
+}
+void WTextureCache::Flush(WGPUDevice device) {
+    WMipmapGenerator::BeginBatch();
+    for (auto &[path, entry] : cache) {
+        if (entry.pending.valid()) {
+            Upload(device, path, entry);
+        }
+    }
+    WMipmapGenerator::EndBatch(device);
+}
+void WTextureCache::Clear() {
+    for (auto &[path, entry] : cache) {
+        Retire(entry);
+    }
+    cache.clear();
+    pendingEviction = 0;
+    pressured = false;
+    if (placeholder) {
+        WRelease(*placeholder);
+        placeholder.reset();
+    }
+    stats = WTextureStreamingStats{};
+}
+WTextureStreamingStats WTextureCache::GetStats() {
+    WTextureStreamingStats current = stats;
+    current.budget = Limit();
+    return current;
+}
+WTexture WTextureCache::Schedule(WGPUDevice device, std::string path, std::function<WImage()> decode) {
+    auto found = cache.find(path);
+    if (found != cache.end()) {
+        return found->second.texture;
+    }
+
+    Entry &entry = cache[path];
+    entry.texture = GetPlaceholder(device);
+    entry.owner = WMemoryScope::Current();
+    entry.lastUsed = frame;
+    entry.pending = textureDecodePool().submit([decode = std::move(decode), mipmaps = streaming]() {
+        WImage image = decode();
+        if (mipmaps) {
+            image.generateMipmaps();
+        }
+        return image;
+    });
+    return entry.texture;
+}
+const WTexture &WTextureCache::GetPlaceholder(WGPUDevice device) {
+    if (!placeholder) {
+        WMemoryScope memoryScope{"WTextureCache"};
+        const unsigned char grey[4] = {128, 128, 128, 255};
+        placeholder = WTextureBuilder::New()
+                          .setFormat(WGPUTextureFormat_RGBA8Unorm)
+                          .build(device, WGPUExtent3D{.width = 1, .height = 1, .depthOrArrayLayers = 1}, 4, grey, 4);
+    }
+    return *placeholder;
+}
+uint64_t WTextureCache::Limit() {
+    if (!pressured) {
+        return budget;
+    }
+    WMemoryStats total = WMemoryTracker::GetTotal();
+    uint64_t memoryBudget = WMemoryTracker::GetBudget();
+    uint64_t headroom = memoryBudget > total.bytes ? memoryBudget - total.bytes : 0;
+    uint64_t limit = stats.residentBytes + headroom;
+    return budget != 0 ? std::min(budget, limit) : limit;
+}
+uint32_t WTextureCache::StartLevel(const WImage &image) {
+    if (!streaming) {
+        return 0;
+    }
+    uint32_t level = 0;
+    while (level < image.getMaxBaseLevel() &&
+           std::max(image.getLevels()[level].width, image.getLevels()[level].height) > StreamingBaseSize) {
+        level++;
+    }
+    return level;
+}
+uint32_t WTextureCache::DesiredLevel(const Entry &entry) {
+    if (!streaming) {
+        return 0;
+    }
+    if (entry.lastUsed != frame || entry.requestedPixels <= 0.0f) {
+        return entry.residentLevel;
+    }
+    const WImage::Level &base = entry.image->getLevels()[0];
+    float ratio = std::max(base.width, base.height) / entry.requestedPixels;
+    uint32_t level = ratio > 1.0f ? (uint32_t)std::floor(std::log2(ratio)) : 0;
+    return std::min(level, entry.image->getMaxBaseLevel());
+}
+uint64_t WTextureCache::LevelBytes(const WImage &image, uint32_t level) {
+    uint64_t bytes = 0;
+    for (uint32_t i = level; i < image.getLevels().size(); i++) {
+        bytes += image.getLevels()[i].size;
+    }
+    return bytes;
+}
+void WTextureCache::Upload(WGPUDevice device, const std::string &path, Entry &entry) {
+    try {
+        entry.image = entry.pending.get();
+    } catch (const std::exception &e) {
+        fmt::println("[WEngine]::[WARN]: Failed to decode texture '{}', keeping the placeholder: {}", path, e.what());
+        return;
+    }
+    MakeResident(device, entry, StartLevel(*entry.image));
+    if (!streaming) {
+        entry.image.reset();
+    }
+}
+void WTextureCache::MakeResident(WGPUDevice device, Entry &entry, uint32_t level) {
+    WPROFILE_FUNCTION();
+    WMemoryScope memoryScope{entry.owner};
+    WTexture texture = WTexture::fromImage(device, *entry.image, level);
+    bool upgrade = level < entry.residentLevel;
+    Retire(entry);
+    entry.texture = texture;
+    entry.residentLevel = level;
+    entry.residentBytes = LevelBytes(*entry.image, level);
+    stats.residentBytes += entry.residentBytes;
+    stats.textures++;
+    if (upgrade) {
+        stats.uploads++;
+    }
+    generation++;
+}
+void WTextureCache::Retire(Entry &entry) {
+    if (entry.residentLevel == NotResident) {
+        return;
+    }
+    if (deletionQueue != nullptr) {
+        deletionQueue->retire(WOwned<WTexture>(entry.texture));
+    } else {
+        WRelease(entry.texture);
+    }
+    stats.residentBytes -= entry.residentBytes;
+    stats.textures--;
+    entry.residentLevel = NotResident;
+    entry.residentBytes = 0;
+    entry.texture = placeholder ? *placeholder : WTexture{};
+}
 
 WVertexLayout WModelVertex::desc() {
     return WVertexLayout::New(sizeof(WModelVertex))
@@ -131,30 +430,228 @@ WModelVertex &WModelVertex::withUV(glm::vec2 uv) {
     return *this;
 }
 
-WMesh WMesh::New(WRenderBundle renderBundle, std::vector<WTexture> textures, std::vector<WBindGroup> bindGroups) {
+WModelCompactBounds WModelCompactBounds::FromVertices(std::span<const WModelVertex> vertices) {
+    glm::vec3 lower{0.0f};
+    glm::vec3 upper{0.0f};
+    if (!vertices.empty()) {
+        lower = upper = vertices[0].position;
+    }
+    for (const WModelVertex &vertex : vertices) {
+        lower = glm::min(lower, vertex.position);
+        upper = glm::max(upper, vertex.position);
+    }
+    return WModelCompactBounds{
+        .origin = glm::vec4(lower, 0.0f),
+        .extent = glm::vec4(glm::max(upper - lower, glm::vec3(1e-6f)), 0.0f),
+    };
+}
+
+static uint16_t quantizeUnorm16(float value) {
+    return (uint16_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+static int16_t quantizeSnorm16(float value) {
+    return (int16_t)std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+static glm::vec3 octahedralDecode(float x, float y) {
+    glm::vec3 n{x, y, 1.0f - std::abs(x) - std::abs(y)};
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+WVertexLayout WModelCompactVertex::desc() {
+    return WVertexLayout::New(sizeof(WModelCompactVertex))
+        .addAttribute(WGPUVertexFormat_Unorm16x4, offsetof(WModelCompactVertex, position), 0)
+        .addAttribute(WGPUVertexFormat_Snorm16x2, offsetof(WModelCompactVertex, normal), 1)
+        .addAttribute(WGPUVertexFormat_Float16x2, offsetof(WModelCompactVertex, uv), 2);
+}
+WModelCompactVertex WModelCompactVertex::Encode(const WModelVertex &vertex,
+                                                const WModelCompactBounds &bounds,
+                                                WModelCompactError *error) {
+    WModelCompactVertex compact{};
+
+    glm::vec3 origin{bounds.origin};
+    glm::vec3 extent{bounds.extent};
+    glm::vec3 relative = (vertex.position - origin) / extent;
+    for (uint32_t i = 0; i < 3; i++) {
+        compact.position[i] = quantizeUnorm16(relative[i]);
+    }
+
+    glm::vec3 normal = vertex.normal;
+    float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+    float octX = normal.x;
+    float octY = normal.y;
+    if (normal.z < 0.0f) {
+        octX = (1.0f - std::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f);
+        octY = (1.0f - std::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    compact.normal[0] = quantizeSnorm16(octX);
+    compact.normal[1] = quantizeSnorm16(octY);
+
+    compact.uv[0] = glm::packHalf1x16(vertex.uv.x);
+    compact.uv[1] = glm::packHalf1x16(vertex.uv.y);
+
+    if (error != nullptr) {
+        for (uint32_t i = 0; i < 3; i++) {
+            float decoded = origin[i] + compact.position[i] / 65535.0f * extent[i];
+            error->position = std::max(error->position, std::abs(decoded - vertex.position[i]));
+        }
+
+        if (length > 0.0f) {
+            glm::vec3 decoded = octahedralDecode(compact.normal[0] / 32767.0f, compact.normal[1] / 32767.0f);
+            float cosine = std::clamp(glm::dot(decoded, glm::normalize(vertex.normal)), -1.0f, 1.0f);
+            error->normalDegrees = std::max(error->normalDegrees, std::acos(cosine) * 57.2957795f);
+        }
+
+        error->uv = std::max({error->uv,
+                              std::abs(glm::unpackHalf1x16(compact.uv[0]) - vertex.uv.x),
+                              std::abs(glm::unpackHalf1x16(compact.uv[1]) - vertex.uv.y)});
+    }
+
+    return compact;
+}
+
+WMeshBounds WMeshBounds::FromVertices(std::span<const WModelVertex> vertices) {
+    glm::vec3 lower{0.0f};
+    glm::vec3 upper{0.0f};
+    if (!vertices.empty()) {
+        lower = upper = vertices[0].position;
+    }
+    for (const WModelVertex &vertex : vertices) {
+        lower = glm::min(lower, vertex.position);
+        upper = glm::max(upper, vertex.position);
+    }
+
+    WMeshBounds bounds{
+        .center = (lower + upper) * 0.5f,
+        .extent = (upper - lower) * 0.5f,
+        .radius = 0.0f,
+    };
+    for (const WModelVertex &vertex : vertices) {
+        bounds.radius = std::max(bounds.radius, glm::length(vertex.position - bounds.center));
+    }
+    return bounds;
+}
+
+WMeshBounds WMeshBounds::FromSkinnedVertices(std::span<const WModelVertex> vertices, const WSkeleton &skeleton) {
+    WMeshBounds bounds = FromVertices(vertices);
+    float reach = 0.0f;
+    for (const WSkeletonJoint &joint : skeleton.joints) {
+        glm::vec3 position{glm::inverse(joint.offset)[3]};
+        reach = std::max(reach, glm::length(position - bounds.center));
+    }
+
+    // A vertex rotated about a joint stays within |v - c| + 2|joint - c| of the bind center.
+    bounds.radius += 2.0f * reach;
+    bounds.extent = glm::vec3(bounds.radius);
+    return bounds;
+}
+
+WVertexLayout WModelInstance::desc() {
+    return WVertexLayout::New(sizeof(WModelInstance))
+        .setStepMode(WGPUVertexStepMode_Instance)
+        .addAttribute(WGPUVertexFormat_Float32x4, offsetof(WModelInstance, transform) + 0 * sizeof(glm::vec4), 5)
+        .addAttribute(WGPUVertexFormat_Float32x4, offsetof(WModelInstance, transform) + 1 * sizeof(glm::vec4), 6)
+        .addAttribute(WGPUVertexFormat_Float32x4, offsetof(WModelInstance, transform) + 2 * sizeof(glm::vec4), 7)
+        .addAttribute(WGPUVertexFormat_Float32x4, offsetof(WModelInstance, transform) + 3 * sizeof(glm::vec4), 8)
+        .addAttribute(WGPUVertexFormat_Float32x4, offsetof(WModelInstance, tint), 9);
+}
+
+WVertexLayout WModelSkinnedVertex::desc() {
+    return WModelSkin::Append(WModelVertex::desc(), sizeof(WModelSkinnedVertex), offsetof(WModelSkinnedVertex, skin));
+}
+WVertexLayout WModelCompactSkinnedVertex::desc() {
+    return WModelSkin::Append(WModelCompactVertex::desc(), sizeof(WModelCompactSkinnedVertex),
+                              offsetof(WModelCompactSkinnedVertex, skin));
+}
+
+WMesh WMesh::New(WGPUDevice device,
+                 WRenderBuffer renderBuffer,
+                 WGPUBindGroupLayout localLayout,
+                 WUniformAllocator *uniformAllocator,
+                 std::vector<WUniformSlice> uniforms,
+                 std::vector<std::string> texturePaths,
+                 std::optional<WMeshBounds> bounds,
+                 WJointPalette *palette,
+                 bool ownsRenderBuffer) {
     WMesh mesh;
-    mesh.renderBundle = renderBundle;
-    mesh.textures = textures;
-    mesh.bindGroups = bindGroups;
+    mesh.renderBuffer = renderBuffer;
+    if (ownsRenderBuffer) {
+        mesh.ownedRenderBuffer = WOwned<WRenderBuffer>(renderBuffer);
+    }
+    mesh.localLayout = localLayout;
+    mesh.uniformAllocator = uniformAllocator;
+    mesh.uniforms = uniforms;
+    mesh.texturePaths = texturePaths;
+    mesh.bounds = bounds;
+    mesh.palette = palette;
+    for (const std::string &path : texturePaths) {
+        mesh.textures.push_back(WTextureCache::GetTexture(path));
+    }
+    mesh.buildLocalGroup(device);
     return mesh;
 }
-void WMesh::render(WGPURenderPassEncoder encoder) {
-    renderBundle.render(encoder);
+bool WMesh::refreshTextures(WGPUDevice device) {
+    bool changed = false;
+    for (uint32_t i = 0; i < texturePaths.size(); i++) {
+        const WTexture &texture = WTextureCache::GetTexture(texturePaths[i]);
+        if ((WGPUTextureView)texture != (WGPUTextureView)textures[i]) {
+            textures[i] = texture;
+            changed = true;
+        }
+    }
+    if (!changed) {
+        return false;
+    }
+
+    buildLocalGroup(device);
+    return true;
+}
+void WMesh::buildLocalGroup(WGPUDevice device) {
+    WBindGroupBuilder localGroupBuilder = WBindGroupBuilder::New();
+    for (uint32_t i = 0; i < textures.size(); i++) {
+        localGroupBuilder.addBindingTexture(i, textures[i]);
+    }
+    for (uint32_t i = 0; i < uniforms.size(); i++) {
+        localGroupBuilder.addBindingUniformDynamic(textures.size() + i, uniformAllocator->getBuffer(), uniforms[i].size,
+                                                   uniforms[i].offset);
+    }
+    if (palette) {
+        localGroupBuilder.addBindingStorage(textures.size() + uniforms.size(), palette->getBuffer(), palette->getSize());
+    }
+    localGroup = WOwned<WBindGroup>(localGroupBuilder.buildWithLayout(device, localLayout));
 }
 
-WModel WModel::New(std::string path, std::vector<WMesh> meshes, WRenderPipeline pipeline, WUniformBuffer modelBuffer, glm::mat4 modelData) {
+WModel WModel::New(WGPUDevice device,
+                   std::string path,
+                   std::vector<WMesh> meshes,
+                   WRenderBundleBuilder bundleBuilder,
+                   WRenderPipeline pipeline,
+                   WUniformAllocator *uniformAllocator,
+                   WUniformSlice modelSlice,
+                   glm::mat4 modelData,
+                   bool instanced) {
     WModel model;
     model.pipeline = pipeline;
-    model.modelBuffer = modelBuffer;
-    model.modelData = modelData;
+    model.uniformAllocator = uniformAllocator;
+    model.modelSlice = modelSlice;
+    model.modelData.transform = modelData;
+    uniformAllocator->write(modelSlice, &model.modelData);
+    model.bundleBuilder = bundleBuilder;
 
-    model.meshes = meshes;
-    std::vector<WGPURenderBundle> renderBundles;
-    renderBundles.reserve(model.meshes.size());
-    for (const WMesh mesh : meshes) {
-        renderBundles.push_back(mesh);
+    model.meshes = std::move(meshes);
+    std::stable_sort(model.meshes.begin(), model.meshes.end(), [](const WMesh &a, const WMesh &b) {
+        return a.getRenderBuffer().getVertexBuffer() < b.getRenderBuffer().getVertexBuffer();
+    });
+    model.instanced = instanced;
+    if (instanced) {
+        WModelInstance instance{.transform = glm::mat4{1.0f}, .tint = glm::vec4{1.0f}};
+        model.setInstances(device, std::span<const WModelInstance>{&instance, 1});
+    } else {
+        model.record(device);
     }
-    model.renderBundles = renderBundles;
 
     fs::path fpath{path};
     model.path = path;
@@ -163,18 +660,190 @@ WModel WModel::New(std::string path, std::vector<WMesh> meshes, WRenderPipeline
 
     return model;
 }
-WModel WModel::New(std::vector<WMesh> meshes,
+WModel WModel::New(WGPUDevice device,
+                   std::vector<WMesh> meshes,
+                   WRenderBundleBuilder bundleBuilder,
                    WRenderPipeline pipeline,
-                   WUniformBuffer modelBuffer,
-                   glm::mat4 modelData) {
-    return WModel::New("", meshes, pipeline, modelBuffer, modelData);
+                   WUniformAllocator *uniformAllocator,
+                   WUniformSlice modelSlice,
+                   glm::mat4 modelData,
+                   bool instanced) {
+    return WModel::New(device, "", std::move(meshes), bundleBuilder, pipeline, uniformAllocator, modelSlice, modelData, instanced);
 }
 void WModel::render(WGPURenderPassEncoder encoder) {
-    wgpuRenderPassEncoderExecuteBundles(encoder, renderBundles.size(), renderBundles.data());
+    visibleBundles.clear();
+    for (const WOwned<WGPURenderBundle> &renderBundle : renderBundles) {
+        visibleBundles.push_back(renderBundle.get());
+    }
+    cullStats = WModelCullStats{.visible = (uint32_t)visibleBundles.size()};
+    wgpuRenderPassEncoderExecuteBundles(encoder, visibleBundles.size(), visibleBundles.data());
 }
-void WModel::updateModel(WGPUQueue queue, glm::mat4 model) {
-    modelData = model;
-    modelBuffer.update(queue, &modelData);
+void WModel::render(WGPURenderPassEncoder encoder, const WFrustum &frustum) {
+    const glm::mat4 &transform = modelData.transform;
+    glm::mat3 linear{transform};
+    glm::mat3 absolute{glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2])};
+    float scale = std::max({glm::length(linear[0]), glm::length(linear[1]), glm::length(linear[2])});
+
+    visibleBundles.clear();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const std::optional<WMeshBounds> &bounds = getCullBounds(i);
+        if (bounds) {
+            glm::vec3 center = glm::vec3(transform * glm::vec4(bounds->center, 1.0f));
+            if (!frustum.intersectsSphere(center, bounds->radius * scale) ||
+                !frustum.intersectsBox(center, absolute * bounds->extent)) {
+                continue;
+            }
+        }
+        visibleBundles.push_back(renderBundles[i].get());
+    }
+
+    cullStats = WModelCullStats{
+        .visible = (uint32_t)visibleBundles.size(),
+        .culled = (uint32_t)(renderBundles.size() - visibleBundles.size()),
+    };
+    if (!visibleBundles.empty()) {
+        wgpuRenderPassEncoderExecuteBundles(encoder, visibleBundles.size(), visibleBundles.data());
+    }
+}
+void WModel::requestTextures(const WFrustum &frustum, glm::vec3 eye, float pixelsPerUnit) const {
+    const glm::mat4 &transform = modelData.transform;
+    glm::mat3 linear{transform};
+    glm::mat3 absolute{glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2])};
+    float scale = std::max({glm::length(linear[0]), glm::length(linear[1]), glm::length(linear[2])});
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        float pixels = std::numeric_limits<float>::max();
+        const std::optional<WMeshBounds> &bounds = getCullBounds(i);
+        if (bounds) {
+            glm::vec3 center = glm::vec3(transform * glm::vec4(bounds->center, 1.0f));
+            glm::vec3 extent = absolute * bounds->extent;
+            if (!frustum.intersectsSphere(center, bounds->radius * scale) || !frustum.intersectsBox(center, extent)) {
+                continue;
+            }
+            float radius = meshes[i].getBounds()->radius * scale * (instanced ? instanceScale : 1.0f);
+            float distance = instanced ? glm::length(glm::max(glm::abs(eye - center) - extent, glm::vec3(0.0f)))
+                                       : glm::length(center - eye);
+            if (distance > radius) {
+                pixels = 2.0f * radius * pixelsPerUnit / distance;
+            }
+        }
+        for (const std::string &path : meshes[i].getTexturePaths()) {
+            WTextureCache::Request(path, pixels);
+        }
+    }
+}
+void WModel::updateModel(glm::mat4 model) {
+    modelData.transform = model;
+    uniformAllocator->write(modelSlice, &modelData);
+}
+void WModel::updateAnimation(float dt) {
+    if (!skeleton) {
+        return;
+    }
+    animationTime += dt;
+    skeleton->sample(0, animationTime, palette->getJoints(modelData.jointOffset, skeleton->joints.size()));
+}
+void WModel::setInstances(WGPUDevice device, std::span<const WModelInstance> instances) {
+    if (!instanced) {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Model '{}' was not built with instancing!", path).c_str());
+    }
+
+    bool reallocated = false;
+    if (instances.size() > instanceCapacity) {
+        instanceCapacity = std::bit_ceil((uint32_t)instances.size());
+        WGPUBufferDescriptor desc{
+            .label = "Model Instances",
+            .usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst,
+            .size = instanceCapacity * sizeof(WModelInstance),
+        };
+        instanceBuffer = WOwned<WGPUBuffer>(wgpuDeviceCreateBuffer(device, &desc));
+        WMemoryTracker::TrackBuffer(instanceBuffer.get(), desc, path);
+        reallocated = true;
+    }
+    if (!instances.empty()) {
+        WGPUQueue queue = wgpuDeviceGetQueue(device);
+        wgpuQueueWriteBuffer(queue, instanceBuffer.get(), 0, instances.data(), instances.size_bytes());
+        wgpuQueueRelease(queue);
+    }
+
+    instanceScale = 0.0f;
+    for (const WModelInstance &instance : instances) {
+        glm::mat3 linear{instance.transform};
+        instanceScale = std::max({instanceScale, glm::length(linear[0]), glm::length(linear[1]), glm::length(linear[2])});
+    }
+    instanceBounds.clear();
+    for (const WMesh &mesh : meshes) {
+        const std::optional<WMeshBounds> &bounds = mesh.getBounds();
+        if (!bounds || instances.empty()) {
+            instanceBounds.push_back(bounds);
+            continue;
+        }
+        glm::vec3 lower{std::numeric_limits<float>::max()};
+        glm::vec3 upper{std::numeric_limits<float>::lowest()};
+        for (const WModelInstance &instance : instances) {
+            glm::mat3 linear{instance.transform};
+            glm::mat3 absolute{glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2])};
+            glm::vec3 center = glm::vec3(instance.transform * glm::vec4(bounds->center, 1.0f));
+            glm::vec3 extent = absolute * bounds->extent;
+            lower = glm::min(lower, center - extent);
+            upper = glm::max(upper, center + extent);
+        }
+        glm::vec3 extent = (upper - lower) * 0.5f;
+        instanceBounds.push_back(WMeshBounds{.center = (lower + upper) * 0.5f, .extent = extent, .radius = glm::length(extent)});
+    }
+
+    if (reallocated || instances.size() != instanceCount) {
+        instanceCount = instances.size();
+        record(device);
+    }
+}
+void WModel::setSkeleton(WSkeleton skeleton, WJointPalette *palette, uint32_t jointOffset) {
+    this->skeleton = std::move(skeleton);
+    this->palette = palette;
+    modelData.jointOffset = jointOffset;
+    uniformAllocator->write(modelSlice, &modelData);
+    this->skeleton->sample(0, 0.0f, palette->getJoints(jointOffset, this->skeleton->joints.size()));
+}
+void WModel::setPipelineSource(WRenderPipelineBuilder pipelineBuilder, const char *vertexEntry, const char *fragmentEntry) {
+    this->pipelineBuilder = pipelineBuilder;
+    this->vertexEntry = vertexEntry;
+    this->fragmentEntry = fragmentEntry;
+}
+WRenderPipeline WModel::buildPipeline(WGPUDevice device, WGPUShaderModule vertexShader, WGPUShaderModule fragmentShader) const {
+    WRenderPipelineBuilder builder = pipelineBuilder;
+    return builder.setVertexState(vertexShader, vertexEntry).setFragmentState(fragmentShader, fragmentEntry).build(device);
+}
+void WModel::setPipeline(WGPUDevice device, WRenderPipeline pipeline) {
+    this->pipeline = pipeline;
+    bundleBuilder.setRenderPipeline(pipeline);
+    record(device);
+}
+bool WModel::refreshTextures(WGPUDevice device) {
+    if (textureGeneration == WTextureCache::GetGeneration()) {
+        return false;
+    }
+    textureGeneration = WTextureCache::GetGeneration();
+
+    bool changed = false;
+    for (WMesh &mesh : meshes) {
+        changed |= mesh.refreshTextures(device);
+    }
+    if (changed) {
+        record(device);
+    }
+    return changed;
+}
+void WModel::record(WGPUDevice device) {
+    WPROFILE_FUNCTION();
+    renderBundles.clear();
+    if (instanced) {
+        bundleBuilder.setInstanceBuffer(instanceBuffer.get(), instanceCount);
+    }
+    for (const WMesh &mesh : meshes) {
+        bundleBuilder.clearDraws();
+        bundleBuilder.addDraw(mesh.getRenderBuffer(), mesh.getLocalGroup());
+        renderBundles.emplace_back(bundleBuilder.build(device));
+    }
 }
 
 WModelBuilder WModelBuilder::New(std::string path) {
@@ -197,154 +866,456 @@ WModelBuilder &WModelBuilder::setVertexShader(WGPUShaderModule vshader, const ch
     this->ventry = entry;
     return *this;
 }
+WModelBuilder &WModelBuilder::setSkinnedVertexEntry(const char *entry) {
+    this->skinnedEntry = entry;
+    return *this;
+}
+WModelBuilder &WModelBuilder::setInstancedVertexEntries(const char *entry, const char *skinnedEntry) {
+    this->instancedEntry = entry;
+    this->skinnedInstancedEntry = skinnedEntry;
+    return *this;
+}
 WModelBuilder &WModelBuilder::setFragmentShader(WGPUShaderModule fshader, const char *entry) {
     this->fshader = fshader;
     this->fentry = entry;
     return *this;
 }
+WModelBuilder &WModelBuilder::setCachePath(std::string cachePath) {
+    this->cachePath = cachePath;
+    return *this;
+}
+WModelBuilder &WModelBuilder::setCacheEnabled(bool enabled) {
+    this->cacheEnabled = enabled;
+    return *this;
+}
+WModelBuilder &WModelBuilder::setThreadCount(uint32_t threadCount) {
+    this->threadCount = threadCount;
+    return *this;
+}
+WModelBuilder &WModelBuilder::setGeometryArena(WGeometryArena *arena) {
+    this->geometryArena = arena;
+    return *this;
+}
+WModelBuilder &WModelBuilder::setUniformAllocator(WUniformAllocator *allocator) {
+    this->uniformAllocator = allocator;
+    return *this;
+}
+WModelBuilder &WModelBuilder::setCompactVertices(bool compact) {
+    this->compactVertices = compact;
+    return *this;
+}
+WModelBuilder &WModelBuilder::setOptimizeMeshes(bool optimize) {
+    this->optimizeMeshes = optimize;
+    return *this;
+}
+WModelBuilder &WModelBuilder::setOptimizeOverdraw(bool optimize) {
+    this->optimizeOverdraw = optimize;
+    return *this;
+}
+WModelBuilder &WModelBuilder::setJointPalette(WJointPalette *palette) {
+    this->jointPalette = palette;
+    return *this;
+}
+WModelBuilder &WModelBuilder::setInstanced(bool instanced) {
+    this->instanced = instanced;
+    return *this;
+}
 WModel WModelBuilder::buildFromFile(WGPUDevice device) {
-    WGPUBindGroupLayout localGroupLayout =
+    WPROFILE_FUNCTION();
+    WMemoryScope memoryScope{path};
+    if (uniformAllocator == nullptr) {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Model '{}' needs a uniform allocator!", path).c_str());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    const uint32_t importFlags = aiProcess_Triangulate |
+                                 aiProcess_GenNormals |
+                                 aiProcess_GenUVCoords |
+                                 aiProcess_FlipUVs |
+                                 aiProcess_JoinIdenticalVertices |
+                                 aiProcess_LimitBoneWeights |
+                                 aiProcess_OptimizeGraph |
+                                 aiProcess_OptimizeMeshes;
+
+    WMappedFile source = WMappedFile::Open(path);
+    if (!source.isOpen()) {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Failed to open model file: '{}'", path).c_str());
+    }
+    uint32_t optimizeFlags = optimizeMeshes ? OPTIMIZE_VERTEX_CACHE | (optimizeOverdraw ? OPTIMIZE_OVERDRAW : 0) : 0;
+    WModelCacheKey cacheKey = WModelCache::KeyFor(source, importFlags, optimizeFlags);
+    std::string cacheFile = cachePath.empty() ? path + ".wcache" : cachePath;
+
+    std::optional<WModelData> data = cacheEnabled ? WModelCache::Load(cacheFile, cacheKey) : std::nullopt;
+    bool warm = data.has_value();
+    if (!warm) {
+        Assimp::Importer importer;
+        const aiScene *scene = nullptr;
+        {
+            WPROFILE_SCOPE("Assimp::ReadFile");
+            scene = importer.ReadFile(path, importFlags);
+        }
+
+        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+            throw std::exception(fmt::format("[WEngine]::[ERROR]: Failed to load model from path: '{}'", path).c_str());
+        }
+
+        auto extractStart = std::chrono::steady_clock::now();
+
+        WSceneGraph graph{};
+        processNode(graph, scene->mRootNode, -1, scene);
+        std::vector<const aiMesh *> &sceneMeshes = graph.meshes;
+
+        bool skinned = scene->mNumAnimations > 0 ||
+                       std::any_of(sceneMeshes.begin(), sceneMeshes.end(), [](const aiMesh *mesh) {
+                           return mesh->HasBones();
+                       });
+        std::vector<uint32_t> jointBases = skinned ? processSkeleton(graph, scene) : std::vector<uint32_t>{};
+
+        uint32_t threads = threadCount == 0 ? WThreadPool::HardwareThreads() : threadCount;
+        std::vector<WImportedMesh> importedMeshes(sceneMeshes.size());
+        std::vector<WMeshCacheStats> cacheStats(sceneMeshes.size());
+        {
+            WThreadPool pool{threads - 1};
+            pool.parallelFor(sceneMeshes.size(), [&](size_t i) {
+                importedMeshes[i] = processMesh(sceneMeshes[i], skinned ? &jointBases[i] : nullptr);
+                if (optimizeMeshes) {
+                    cacheStats[i] = optimizeMesh(importedMeshes[i], optimizeOverdraw);
+                }
+            });
+        }
+
+        fmt::println("[WEngine]::[INFO]: Extracted {} meshes from '{}' on {} thread(s) in {:.2f} ms",
+                     sceneMeshes.size(), path, threads,
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - extractStart).count());
+
+        if (optimizeMeshes) {
+            WMeshCacheStats total{};
+            for (const WMeshCacheStats &stats : cacheStats) {
+                total.triangles += stats.triangles;
+                total.vertices += stats.vertices;
+                total.verticesAfter += stats.verticesAfter;
+                total.transformedBefore += stats.transformedBefore;
+                total.transformedAfter += stats.transformedAfter;
+            }
+            fmt::println("[WEngine]::[INFO]: Optimized '{}' for a {}-entry vertex cache{}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                         path, VERTEX_CACHE_SIZE, optimizeOverdraw ? " and overdraw" : "",
+                         total.acmr(total.transformedBefore), total.acmr(total.transformedAfter),
+                         WMeshCacheStats::atvr(total.transformedBefore, total.vertices),
+                         WMeshCacheStats::atvr(total.transformedAfter, total.verticesAfter));
+        }
+
+        std::vector<WImportedMaterial> importedMaterials{};
+        importedMaterials.reserve(scene->mNumMaterials);
+        for (uint32_t i = 0; i < scene->mNumMaterials; i++) {
+            importedMaterials.push_back(processMaterial(aiTextureType_DIFFUSE, scene->mMaterials[i], scene));
+        }
+
+        std::vector<unsigned char> bytes =
+            WModelCache::Serialize(cacheKey, importedMeshes, importedMaterials, skinned ? &graph.skeleton : nullptr);
+        if (cacheEnabled && !WModelCache::Store(cacheFile, bytes)) {
+            fmt::println("[WEngine]::[WARN]: Failed to write model cache: '{}'", cacheFile);
+        }
+        data = WModelData::FromBytes(std::move(bytes));
+        if (!data) {
+            throw std::exception(fmt::format("[WEngine]::[ERROR]: Failed to flatten model: '{}'", path).c_str());
+        }
+    }
+    source = WMappedFile();
+
+    auto imported = std::chrono::steady_clock::now();
+
+    bool skinned = data->skeleton.has_value();
+    if (skinned && jointPalette == nullptr) {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Model '{}' is skinned but no joint palette was set!", path).c_str());
+    }
+
+    WBindGroupLayoutBuilder localGroupLayoutBuilder =
         WBindGroupLayoutBuilder::New()
             .addBindingTexture(0)
-            .addBindingUniform(1)
-            .build(device);
+            .addBindingUniform(1, WGPUShaderStage_Vertex | WGPUShaderStage_Fragment | WGPUShaderStage_Compute, true);
+    if (compactVertices) {
+        localGroupLayoutBuilder.addBindingUniform(2, WGPUShaderStage_Vertex | WGPUShaderStage_Fragment | WGPUShaderStage_Compute, true);
+    }
+    if (skinned) {
+        localGroupLayoutBuilder.addBindingStorage(compactVertices ? 3 : 2);
+    }
+    WGPUBindGroupLayout localGroupLayout = localGroupLayoutBuilder.build(device);
 
-    WRenderPipeline pipeline =
+    WVertexLayout vertexLayout = compactVertices ? (skinned ? WModelCompactSkinnedVertex::desc() : WModelCompactVertex::desc())
+                                                 : (skinned ? WModelSkinnedVertex::desc() : WModelVertex::desc());
+    const char *vertexEntry = instanced ? (skinned ? skinnedInstancedEntry : instancedEntry)
+                                        : (skinned ? skinnedEntry : ventry);
+    WRenderPipelineBuilder pipelineBuilder =
         WRenderPipelineBuilder::New()
             .addBindGroupLayout(globalBindGroup)
             .addBindGroupLayout(localGroupLayout)
-            .setVertexState(vshader, ventry)
+            .setVertexState(vshader, vertexEntry)
             .setFragmentState(fshader, fentry)
-            .addVertexBufferLayout(WModelVertex::desc())
+            .addVertexBufferLayout(vertexLayout)
             .addColorTarget(colorTargetFormat)
-            .setDefaultDepthState()
-            .build(device);
-
-    glm::mat4 modelData{1.0f};
-    WUniformBuffer modelBuffer = WUniformBuffer::New(device, &modelData, sizeof(modelData));
-
-    Assimp::Importer importer;
-    const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate |
-                                                       aiProcess_GenNormals |
-                                                       aiProcess_GenUVCoords |
-                                                       aiProcess_FlipUVs |
-                                                       aiProcess_JoinIdenticalVertices |
-                                                       aiProcess_OptimizeGraph |
-                                                       aiProcess_OptimizeMeshes);
+            .setDefaultDepthState();
+    if (instanced) {
+        pipelineBuilder.addVertexBufferLayout(WModelInstance::desc());
+    }
+    WRenderPipeline pipeline = pipelineBuilder.build(device);
 
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-        throw std::exception(fmt::format("[WEngine]::[ERROR]: Failed to load model from path: '{}'", path).c_str());
+    WModelUniform modelData{.transform = glm::mat4{1.0f}};
+    if (skinned) {
+        modelData.jointOffset = jointPalette->allocate(data->skeleton->joints.size());
     }
+    WUniformSlice modelSlice = uniformAllocator->allocate(sizeof(WModelUniform));
 
     fs::path fpath{path};
     std::string directory = fpath.parent_path().string();
 
     std::vector<WMesh> meshes{};
-    processNode(device, meshes, colorTargetFormat, globalBindGroup, localGroupLayout, modelBuffer,
-                pipeline, directory, scene->mRootNode, scene);
+    meshes.reserve(data->meshes.size());
+    size_t indexBytes = 0;
+    size_t wideIndexBytes = 0;
+    size_t vertexBytes = 0;
+    size_t wideVertexBytes = 0;
+    WModelCompactError compactError{};
+    for (const WMeshData &mesh : data->meshes) {
+        meshes.push_back(createMesh(device, geometryArena, localGroupLayout, uniformAllocator, modelSlice,
+                                    skinned ? jointPalette : nullptr,
+                                    skinned ? &*data->skeleton : nullptr,
+                                    directory, mesh, data->materials[mesh.materialIndex],
+                                    compactVertices ? &compactError : nullptr));
+        indexBytes += meshes.back().getRenderBuffer().getIndicesSize();
+        wideIndexBytes += mesh.indices.size_bytes();
+        vertexBytes += meshes.back().getRenderBuffer().getVerticesSize();
+        wideVertexBytes += mesh.vertices.size() * (skinned ? sizeof(WModelSkinnedVertex) : sizeof(WModelVertex));
+    }
+
+    WRenderBundleBuilder bundleBuilder =
+        WRenderBundleBuilder::New()
+            .addBindGroup(globalBindGroup)
+            .setRenderPipeline(pipeline)
+            .addColorFormat(colorTargetFormat)
+            .setDefaultDepthFormat();
+    WModel model = WModel::New(device, path, std::move(meshes), bundleBuilder, pipeline, uniformAllocator, modelSlice,
+                               modelData.transform, instanced);
+    if (skinned) {
+        fmt::println("[WEngine]::[INFO]: Model '{}' skinned: {} nodes, {} joints at palette offset {}, {} clip(s)",
+                     path, data->skeleton->nodes.size(), data->skeleton->joints.size(), modelData.jointOffset,
+                     data->skeleton->clips.size());
+        model.setSkeleton(std::move(*data->skeleton), jointPalette, modelData.jointOffset);
+    }
+    model.setPipelineSource(pipelineBuilder, vertexEntry, fentry);
 
-    return WModel::New(path, meshes, pipeline, modelBuffer, modelData);
+    auto built = std::chrono::steady_clock::now();
+    fmt::println("[WEngine]::[INFO]: Loaded model '{}' ({}) in {:.2f} ms: import {:.2f} ms, gpu upload {:.2f} ms",
+                 path,
+                 warm ? "warm, cache" : "cold, assimp",
+                 std::chrono::duration<double, std::milli>(built - start).count(),
+                 std::chrono::duration<double, std::milli>(imported - start).count(),
+                 std::chrono::duration<double, std::milli>(built - imported).count());
+
+    fmt::println("[WEngine]::[INFO]: Model '{}' index buffers: {:.2f} KiB ({:.2f} KiB saved by 16-bit indices)",
+                 path, indexBytes / 1024.0, (wideIndexBytes - indexBytes) / 1024.0);
+    if (compactVertices) {
+        fmt::println("[WEngine]::[INFO]: Model '{}' compact vertices: {:.2f} KiB -> {:.2f} KiB ({:.1f}%), "
+                     "max error: position {:.6f}, normal {:.4f} deg, uv {:.6f}",
+                     path, wideVertexBytes / 1024.0, vertexBytes / 1024.0,
+                     wideVertexBytes == 0 ? 0.0 : 100.0 * vertexBytes / wideVertexBytes,
+                     compactError.position, compactError.normalDegrees, compactError.uv);
+    }
+    if (geometryArena) {
+        geometryArena->printStats();
+    }
+
+    return model;
 }
 
-void processNode(WGPUDevice device,
-                 std::vector<WMesh> &meshes,
-                 WGPUTextureFormat colorTargetFormat,
-                 WBindGroup globalGroup,
-                 WGPUBindGroupLayout localBindGroupLayout,
-                 WUniformBuffer modelBuffer,
-                 WRenderPipeline pipeline,
-                 const std::string &directory,
+void processNode(WSceneGraph &graph,
                  const aiNode *node,
+                 int32_t parent,
                  const aiScene *scene) {
+    uint32_t index = graph.skeleton.nodes.size();
+    graph.skeleton.nodes.push_back(WSkeletonNode{
+        .parent = parent,
+        .transform = AssimpToGlm::aiMatrix4x4ToGlm(node->mTransformation),
+    });
+    graph.nodeIndices.emplace(node->mName.C_Str(), index);
+
     for (uint32_t i = 0; i < node->mNumMeshes; i++) {
-        meshes.push_back(processMesh(device, colorTargetFormat, globalGroup, localBindGroupLayout, modelBuffer,
-                                     pipeline, directory, scene->mMeshes[node->mMeshes[i]], scene));
+        graph.meshes.push_back(scene->mMeshes[node->mMeshes[i]]);
+        graph.meshNodes.push_back(index);
     }
     for (uint32_t i = 0; i < node->mNumChildren; i++) {
-        processNode(device, meshes, colorTargetFormat, globalGroup, localBindGroupLayout, modelBuffer,
-                    pipeline, directory, node->mChildren[i], scene);
-    }
-}
-WMesh processMesh(WGPUDevice device,
-                  WGPUTextureFormat colorTargetFormat,
-                  WBindGroup globalGroup,
-                  WGPUBindGroupLayout localBindGroupLayout,
-                  WUniformBuffer modelBuffer,
-                  WRenderPipeline pipeline,
-                  const std::string &directory,
-                  const aiMesh *mesh,
-                  const aiScene *scene) {
-    std::vector<WModelVertex> vertices{};
-    std::vector<uint32_t> indices{};
-    std::vector<WTexture> textures;
-
-    vertices.reserve(mesh->mNumVertices);
-    indices.reserve(mesh->mNumFaces * 3);
+        processNode(graph, node->mChildren[i], index, scene);
+    }
+}
+std::vector<uint32_t> processSkeleton(WSceneGraph &graph, const aiScene *scene) {
+    WSkeleton &skeleton = graph.skeleton;
+    skeleton.globalInverse = glm::inverse(skeleton.nodes[0].transform);
 
+    std::vector<uint32_t> jointBases;
+    jointBases.reserve(graph.meshes.size());
+    for (size_t i = 0; i < graph.meshes.size(); i++) {
+        const aiMesh *mesh = graph.meshes[i];
+        jointBases.push_back(skeleton.joints.size());
+        if (!mesh->HasBones()) {
+            skeleton.joints.push_back(WSkeletonJoint{.node = graph.meshNodes[i], .offset = glm::mat4{1.0f}});
+            continue;
+        }
+        for (uint32_t j = 0; j < mesh->mNumBones; j++) {
+            const aiBone *bone = mesh->mBones[j];
+            auto found = graph.nodeIndices.find(bone->mName.C_Str());
+            skeleton.joints.push_back(WSkeletonJoint{
+                .node = found != graph.nodeIndices.end() ? found->second : graph.meshNodes[i],
+                .offset = AssimpToGlm::aiMatrix4x4ToGlm(bone->mOffsetMatrix),
+            });
+        }
+    }
+    if (skeleton.joints.size() > std::numeric_limits<uint16_t>::max() + 1ull) {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Too many joints in a model: {}", skeleton.joints.size()).c_str());
+    }
+
+    for (uint32_t i = 0; i < scene->mNumAnimations; i++) {
+        const aiAnimation *animation = scene->mAnimations[i];
+        WAnimationClip clip{
+            .name = animation->mName.C_Str(),
+            .duration = (float)animation->mDuration,
+            .ticksPerSecond = animation->mTicksPerSecond != 0.0 ? (float)animation->mTicksPerSecond : 25.0f,
+        };
+        for (uint32_t j = 0; j < animation->mNumChannels; j++) {
+            const aiNodeAnim *channel = animation->mChannels[j];
+            auto found = graph.nodeIndices.find(channel->mNodeName.C_Str());
+            if (found == graph.nodeIndices.end()) {
+                continue;
+            }
+
+            WAnimationChannel imported{.node = found->second};
+            for (uint32_t k = 0; k < channel->mNumPositionKeys; k++) {
+                const aiVectorKey &key = channel->mPositionKeys[k];
+                imported.positions.push_back(WVectorKey{(float)key.mTime, AssimpToGlm::aiVector3ToGlm(key.mValue)});
+            }
+            for (uint32_t k = 0; k < channel->mNumRotationKeys; k++) {
+                const aiQuatKey &key = channel->mRotationKeys[k];
+                imported.rotations.push_back(WQuatKey{(float)key.mTime, AssimpToGlm::aiQuaternionToGlm(key.mValue)});
+            }
+            for (uint32_t k = 0; k < channel->mNumScalingKeys; k++) {
+                const aiVectorKey &key = channel->mScalingKeys[k];
+                imported.scales.push_back(WVectorKey{(float)key.mTime, AssimpToGlm::aiVector3ToGlm(key.mValue)});
+            }
+            clip.channels.push_back(std::move(imported));
+        }
+        skeleton.clips.push_back(std::move(clip));
+    }
+
+    return jointBases;
+}
+static void normalizeSkin(WModelSkin &skin, glm::vec4 weights, uint16_t fallbackJoint) {
+    float total = weights.x + weights.y + weights.z + weights.w;
+    if (total <= 0.0f) {
+        skin = WModelSkin{.joints = {fallbackJoint, 0, 0, 0}, .weights = {255, 0, 0, 0}};
+        return;
+    }
+
+    uint32_t sum = 0;
+    uint32_t largest = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        skin.weights[i] = (uint8_t)std::lround(weights[i] / total * 255.0f);
+        sum += skin.weights[i];
+        largest = weights[i] > weights[largest] ? i : largest;
+    }
+    skin.weights[largest] = (uint8_t)(skin.weights[largest] + 255 - (int32_t)sum);
+}
+WImportedMesh processMesh(const aiMesh *mesh, const uint32_t *jointBase) {
+    WPROFILE_FUNCTION();
+    WImportedMesh imported{.materialIndex = mesh->mMaterialIndex};
+    std::vector<WModelVertex> &vertices = imported.vertices;
+    std::vector<uint32_t> &indices = imported.indices;
+
+    size_t indicesCount = 0;
+    for (uint32_t i = 0; i < mesh->mNumFaces; i++) {
+        indicesCount += mesh->mFaces[i].mNumIndices;
+    }
+    vertices.resize(mesh->mNumVertices);
+    indices.resize(indicesCount);
+
+    const aiVector3D *uvs = mesh->mTextureCoords[0];
     for (uint32_t i = 0; i < mesh->mNumVertices; i++) {
-        glm::vec3 position = AssimpToGlm::aiVector3ToGlm(mesh->mVertices[i]);
-        glm::vec3 normal = AssimpToGlm::aiVector3ToGlm(mesh->mNormals[i]);
-        glm::vec2 uv = mesh->mTextureCoords[0] ? AssimpToGlm::aiVector3ToGlmVec2(mesh->mTextureCoords[0][i])
-                                               : glm::vec2(0.0f);
-        vertices.push_back(WModelVertex::New()
-                               .withPosition(position)
-                               .withNormal(normal)
-                               .withUV(uv));
+        vertices[i] = WModelVertex::New()
+                          .withPosition(AssimpToGlm::aiVector3ToGlm(mesh->mVertices[i]))
+                          .withNormal(AssimpToGlm::aiVector3ToGlm(mesh->mNormals[i]))
+                          .withUV(uvs ? AssimpToGlm::aiVector3ToGlmVec2(uvs[i]) : glm::vec2(0.0f));
     }
+    uint32_t *index = indices.data();
     for (uint32_t i = 0; i < mesh->mNumFaces; i++) {
-        for (uint32_t j = 0; j < mesh->mFaces[i].mNumIndices; j++) {
-            indices.push_back(mesh->mFaces[i].mIndices[j]);
-        }
+        const aiFace &face = mesh->mFaces[i];
+        index = std::copy(face.mIndices, face.mIndices + face.mNumIndices, index);
     }
 
-    if (mesh->mMaterialIndex >= 0) {
-        textures.push_back(loadMaterialTextures(device,
-                                                aiTextureType_DIFFUSE,
-                                                directory,
-                                                scene->mMaterials[mesh->mMaterialIndex],
-                                                scene));
-        // textures.push_back(loadMaterialTextures(device,
-        //                                         aiTextureType_SPECULAR,
-        //                                         directory,
-        //                                         scene->mMaterials[mesh->mMaterialIndex],
-        //                                         scene));
-        // textures.push_back(loadMaterialTextures(device,
-        //                                         aiTextureType_NORMALS,
-        //                                         directory,
-        //                                         scene->mMaterials[mesh->mMaterialIndex],
-        //                                         scene));
+    if (jointBase != nullptr) {
+        imported.skins.resize(mesh->mNumVertices);
+        std::vector<glm::vec4> weights(mesh->mNumVertices, glm::vec4{0.0f});
+        for (uint32_t i = 0; i < mesh->mNumBones; i++) {
+            const aiBone *bone = mesh->mBones[i];
+            for (uint32_t j = 0; j < bone->mNumWeights; j++) {
+                const aiVertexWeight &weight = bone->mWeights[j];
+                glm::vec4 &slots = weights[weight.mVertexId];
+                uint32_t slot = 0;
+                for (uint32_t k = 1; k < 4; k++) {
+                    slot = slots[k] < slots[slot] ? k : slot;
+                }
+                if (weight.mWeight > slots[slot]) {
+                    slots[slot] = weight.mWeight;
+                    imported.skins[weight.mVertexId].joints[slot] = (uint16_t)(*jointBase + i);
+                }
+            }
+        }
+        for (uint32_t i = 0; i < mesh->mNumVertices; i++) {
+            normalizeSkin(imported.skins[i], weights[i], (uint16_t)*jointBase);
+        }
     }
 
-    WBindGroupBuilder localGroupBuilder = WBindGroupBuilder::New();
-    for (uint32_t i = 0; i < textures.size(); i++) {
-        localGroupBuilder.addBindingTexture(i, textures[i]);
+    return imported;
+}
+WMeshCacheStats optimizeMesh(WImportedMesh &mesh, bool overdraw) {
+    WPROFILE_FUNCTION();
+    std::vector<uint32_t> &indices = mesh.indices;
+    std::vector<WModelVertex> &vertices = mesh.vertices;
+
+    WMeshCacheStats stats{
+        .triangles = indices.size() / 3,
+        .vertices = vertices.size(),
+        .verticesAfter = vertices.size(),
+    };
+    if (indices.empty() || vertices.empty()) {
+        return stats;
     }
-    localGroupBuilder.addBindingUniform(textures.size(), modelBuffer);
-    WBindGroup localGroup = localGroupBuilder.buildWithLayout(device, localBindGroupLayout);
 
-    WRenderBuffer renderBuffer =
-        WRenderBufferBuilder::New()
-            .setVertices(vertices)
-            .setIndices(indices)
-            .build(device);
+    stats.transformedBefore = meshopt_analyzeVertexCache(indices.data(), indices.size(), vertices.size(),
+                                                         VERTEX_CACHE_SIZE, 0, 0)
+                                  .vertices_transformed;
 
-    WRenderBundle renderBundle =
-        WRenderBundleBuilder::New()
-            .addBindGroup(globalGroup)
-            .addBindGroup(localGroup)
-            .setRenderPipeline(pipeline)
-            .setRenderBuffer(renderBuffer)
-            .addColorFormat(colorTargetFormat)
-            .setDefaultDepthFormat()
-            .build(device);
+    meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertices.size());
+    if (overdraw) {
+        meshopt_optimizeOverdraw(indices.data(), indices.data(), indices.size(), &vertices[0].position.x,
+                                 vertices.size(), sizeof(WModelVertex), 1.05f);
+    }
+    std::vector<uint32_t> remap(vertices.size());
+    size_t fetched = meshopt_optimizeVertexFetchRemap(remap.data(), indices.data(), indices.size(), vertices.size());
+    meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+    meshopt_remapVertexBuffer(vertices.data(), vertices.data(), vertices.size(), sizeof(WModelVertex), remap.data());
+    vertices.resize(fetched);
+    stats.verticesAfter = fetched;
+    if (!mesh.skins.empty()) {
+        meshopt_remapVertexBuffer(mesh.skins.data(), mesh.skins.data(), mesh.skins.size(), sizeof(WModelSkin), remap.data());
+        mesh.skins.resize(fetched);
+    }
 
-    return WMesh::New(renderBundle, textures, {globalGroup, localGroup});
+    stats.transformedAfter = meshopt_analyzeVertexCache(indices.data(), indices.size(), vertices.size(),
+                                                        VERTEX_CACHE_SIZE, 0, 0)
+                                 .vertices_transformed;
+    return stats;
 }
-WTexture loadMaterialTextures(WGPUDevice device,
-                              aiTextureType type,
-                              const std::string directory,
-                              const aiMaterial *material,
-                              const aiScene *scene) {
+WImportedMaterial processMaterial(aiTextureType type,
+                                  const aiMaterial *material,
+                                  const aiScene *scene) {
     switch (type) {
         case aiTextureType_DIFFUSE:
         case aiTextureType_SPECULAR:
@@ -354,15 +1325,127 @@ WTexture loadMaterialTextures(WGPUDevice device,
             throw std::exception("[WEngine]::[ERROR]: There is no such assimp material texture type!");
     }
 
-    for (uint32_t i = 0; i < material->GetTextureCount(type); i++) {
-        aiString name;
-        material->GetTexture(type, i, &name);
-        std::string path = directory + "/" + name.C_Str();
+    WImportedMaterial imported{};
+    if (material->GetTextureCount(type) == 0) {
+        return imported;
+    }
+
+    aiString name;
+    material->GetTexture(type, 0, &name);
+    imported.diffuse = name.C_Str();
+
+    const aiTexture *assimpTexture = scene->GetEmbeddedTexture(name.C_Str());
+    if (assimpTexture != nullptr) {
+        if (assimpTexture->mHeight == 0) {
+            const unsigned char *bytes = (const unsigned char *)assimpTexture->pcData;
+            imported.embedded.assign(bytes, bytes + assimpTexture->mWidth);
+        } else {
+            size_t texels = (size_t)assimpTexture->mWidth * assimpTexture->mHeight;
+            imported.embedded.reserve(texels * 4);
+            for (size_t i = 0; i < texels; i++) {
+                const aiTexel &texel = assimpTexture->pcData[i];
+                imported.embedded.insert(imported.embedded.end(), {texel.r, texel.g, texel.b, texel.a});
+            }
+            imported.embeddedWidth = assimpTexture->mWidth;
+            imported.embeddedHeight = assimpTexture->mHeight;
+        }
+    }
+
+    return imported;
+}
+template <typename Vertex>
+static WRenderBuffer uploadGeometry(WGPUDevice device,
+                                    WGeometryArena *geometryArena,
+                                    std::span<const Vertex> vertices,
+                                    std::span<const uint32_t> indices) {
+    return geometryArena ? geometryArena->allocate(device, vertices, indices)
+                         : WRenderBufferBuilder::New()
+                               .setVertices(vertices)
+                               .setIndices(indices)
+                               .build(device);
+}
+WMesh createMesh(WGPUDevice device,
+                 WGeometryArena *geometryArena,
+                 WGPUBindGroupLayout localBindGroupLayout,
+                 WUniformAllocator *uniformAllocator,
+                 WUniformSlice modelSlice,
+                 WJointPalette *palette,
+                 const WSkeleton *skeleton,
+                 const std::string &directory,
+                 const WMeshData &mesh,
+                 const WMaterialData &material,
+                 WModelCompactError *compactError) {
+    WPROFILE_FUNCTION();
+    std::vector<std::string> texturePaths;
+    texturePaths.push_back(loadMaterialTextures(device, directory, material));
+
+    bool skinned = !mesh.skins.empty();
+    std::optional<WMeshBounds> meshBounds = std::nullopt;
+    if (!skinned) {
+        meshBounds = WMeshBounds::FromVertices(mesh.vertices);
+    } else if (skeleton != nullptr) {
+        meshBounds = WMeshBounds::FromSkinnedVertices(mesh.vertices, *skeleton);
+    }
+    if (compactError == nullptr) {
+        if (!skinned) {
+            WRenderBuffer renderBuffer = uploadGeometry(device, geometryArena, mesh.vertices, mesh.indices);
+            return WMesh::New(device, renderBuffer, localBindGroupLayout, uniformAllocator, {modelSlice}, texturePaths,
+                              meshBounds, nullptr, geometryArena == nullptr);
+        }
+
+        std::vector<WModelSkinnedVertex> vertices(mesh.vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            vertices[i] = WModelSkinnedVertex{mesh.vertices[i], mesh.skins[i]};
+        }
+        WRenderBuffer renderBuffer =
+            uploadGeometry(device, geometryArena, std::span<const WModelSkinnedVertex>{vertices}, mesh.indices);
+        return WMesh::New(device, renderBuffer, localBindGroupLayout, uniformAllocator, {modelSlice}, texturePaths,
+                          meshBounds, palette, geometryArena == nullptr);
+    }
+
+    WModelCompactBounds bounds = WModelCompactBounds::FromVertices(mesh.vertices);
+    WRenderBuffer renderBuffer;
+    if (!skinned) {
+        std::vector<WModelCompactVertex> vertices(mesh.vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            vertices[i] = WModelCompactVertex::Encode(mesh.vertices[i], bounds, compactError);
+        }
+        renderBuffer = uploadGeometry(device, geometryArena, std::span<const WModelCompactVertex>{vertices}, mesh.indices);
+    } else {
+        std::vector<WModelCompactSkinnedVertex> vertices(mesh.vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            vertices[i] = WModelCompactSkinnedVertex{WModelCompactVertex::Encode(mesh.vertices[i], bounds, compactError),
+                                                     mesh.skins[i]};
+        }
+        renderBuffer =
+            uploadGeometry(device, geometryArena, std::span<const WModelCompactSkinnedVertex>{vertices}, mesh.indices);
+    }
+    WUniformSlice boundsSlice = uniformAllocator->allocate(sizeof(bounds));
+    uniformAllocator->write(boundsSlice, &bounds);
 
-        const aiTexture *assimpTexture = scene->GetEmbeddedTexture(name.C_Str());
-        return assimpTexture == nullptr ? WTextureCache::New(device, path)
-                                        : WTextureCache::New(device, path, assimpTexture->pcData, assimpTexture->mWidth);
+    return WMesh::New(device, renderBuffer, localBindGroupLayout, uniformAllocator, {modelSlice, boundsSlice},
+                      texturePaths, meshBounds, skinned ? palette : nullptr, geometryArena == nullptr);
+}
+std::string loadMaterialTextures(WGPUDevice device,
+                                 const std::string directory,
+                                 const WMaterialData &material) {
+    if (material.diffuse.empty()) {
+        throw std::exception("[WEngine]::[ERROR]: Assimp material texture should have existed with this type at least once!");
     }
 
-    throw std::exception("[WEngine]::[ERROR]: Assimp material texture should have existed with this type at least once!");
+    std::string path = directory + "/" + material.diffuse;
+    if (material.embedded.empty()) {
+        fs::path compressed = fs::path(path).replace_extension(".ktx2");
+        std::string fallback;
+        if (fs::exists(compressed)) {
+            fallback = path;
+            path = compressed.string();
+        }
+        WTextureCache::New(device, path, fallback);
+    } else if (material.embeddedHeight != 0) {
+        WTextureCache::New(device, path, material.embedded.data(), material.embeddedWidth, material.embeddedHeight);
+    } else {
+        WTextureCache::New(device, path, material.embedded.data(), material.embedded.size());
+    }
+    return path;
 }
@@ -0,0 +1,391 @@
+#include <WModelCache.hpp>
+
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <utility>
+
+#ifdef WENGINE_PLATFORM_WINDOWS
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace fs = std::filesystem;
+
+struct WModelCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t importFlags;
+    uint32_t vertexStride;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint32_t meshCount;
+    uint32_t materialCount;
+    uint32_t optimizeFlags;
+    uint32_t padding;
+    uint64_t meshTableOffset;
+    uint64_t materialTableOffset;
+    uint64_t skeletonOffset;
+    uint64_t skeletonSize;
+    uint64_t fileSize;
+};
+
+struct WModelCacheMesh {
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t skinOffset;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t materialIndex;
+    uint32_t hasSkin;
+};
+
+struct WModelCacheMaterial {
+    uint64_t diffuseOffset;
+    uint64_t embeddedOffset;
+    uint32_t diffuseLength;
+    uint32_t embeddedLength;
+    uint32_t embeddedWidth;
+    uint32_t embeddedHeight;
+};
+
+static constexpr uint64_t BLOB_ALIGNMENT = 16;
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+WMappedFile WMappedFile::Open(const std::string &path) {
+    WMappedFile file;
+#ifdef WENGINE_PLATFORM_WINDOWS
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return file;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        CloseHandle(handle);
+        return file;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(handle);
+        return file;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        return file;
+    }
+    file.fileHandle = handle;
+    file.mappingHandle = mapping;
+    file.bytes = (const unsigned char *)view;
+    file.length = (size_t)size.QuadPart;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return file;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return file;
+    }
+    void *view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return file;
+    }
+    file.bytes = (const unsigned char *)view;
+    file.length = (size_t)info.st_size;
+#endif
+    return file;
+}
+WMappedFile::WMappedFile(WMappedFile &&other) noexcept {
+    *this = std::move(other);
+}
+WMappedFile &WMappedFile::operator=(WMappedFile &&other) noexcept {
+    if (this != &other) {
+        close();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+#ifdef WENGINE_PLATFORM_WINDOWS
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+WMappedFile::~WMappedFile() {
+    close();
+}
+void WMappedFile::close() {
+    if (bytes == nullptr) {
+        return;
+    }
+#ifdef WENGINE_PLATFORM_WINDOWS
+    UnmapViewOfFile(bytes);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap((void *)bytes, length);
+#endif
+    bytes = nullptr;
+    length = 0;
+}
+
+std::optional<WModelData> WModelData::FromBytes(std::vector<unsigned char> bytes) {
+    WModelData data;
+    data.bytes = std::move(bytes);
+    if (!data.parse(data.bytes)) {
+        return std::nullopt;
+    }
+    return data;
+}
+std::optional<WModelData> WModelData::FromFile(WMappedFile file) {
+    WModelData data;
+    data.file = std::move(file);
+    if (!data.parse(data.file.span())) {
+        return std::nullopt;
+    }
+    return data;
+}
+bool WModelData::parse(std::span<const unsigned char> blob) {
+    auto inside = [&](uint64_t offset, uint64_t size) {
+        return offset <= blob.size() && size <= blob.size() - offset;
+    };
+
+    WModelCacheHeader header;
+    if (!inside(0, sizeof(header))) {
+        return false;
+    }
+    memcpy(&header, blob.data(), sizeof(header));
+    if (header.fileSize != blob.size() ||
+        !inside(header.meshTableOffset, (uint64_t)header.meshCount * sizeof(WModelCacheMesh)) ||
+        !inside(header.materialTableOffset, (uint64_t)header.materialCount * sizeof(WModelCacheMaterial))) {
+        return false;
+    }
+
+    meshes.clear();
+    meshes.reserve(header.meshCount);
+    for (uint32_t i = 0; i < header.meshCount; i++) {
+        WModelCacheMesh entry;
+        memcpy(&entry, blob.data() + header.meshTableOffset + i * sizeof(WModelCacheMesh), sizeof(entry));
+        if (entry.vertexOffset % BLOB_ALIGNMENT != 0 || entry.indexOffset % BLOB_ALIGNMENT != 0 ||
+            !inside(entry.vertexOffset, (uint64_t)entry.vertexCount * sizeof(WModelVertex)) ||
+            !inside(entry.indexOffset, (uint64_t)entry.indexCount * sizeof(uint32_t)) ||
+            entry.materialIndex >= header.materialCount) {
+            return false;
+        }
+        std::span<const WModelSkin> skins;
+        if (entry.hasSkin) {
+            if (entry.skinOffset % BLOB_ALIGNMENT != 0 ||
+                !inside(entry.skinOffset, (uint64_t)entry.vertexCount * sizeof(WModelSkin))) {
+                return false;
+            }
+            skins = {(const WModelSkin *)(blob.data() + entry.skinOffset), entry.vertexCount};
+        }
+        meshes.push_back(WMeshData{
+            .vertices = {(const WModelVertex *)(blob.data() + entry.vertexOffset), entry.vertexCount},
+            .indices = {(const uint32_t *)(blob.data() + entry.indexOffset), entry.indexCount},
+            .skins = skins,
+            .materialIndex = entry.materialIndex,
+        });
+    }
+
+    skeleton.reset();
+    if (header.skeletonSize > 0) {
+        if (!inside(header.skeletonOffset, header.skeletonSize)) {
+            return false;
+        }
+        skeleton = WSkeleton::Deserialize(blob.subspan(header.skeletonOffset, header.skeletonSize));
+        if (!skeleton.has_value()) {
+            return false;
+        }
+    }
+
+    materials.clear();
+    materials.reserve(header.materialCount);
+    for (uint32_t i = 0; i < header.materialCount; i++) {
+        WModelCacheMaterial entry;
+        memcpy(&entry, blob.data() + header.materialTableOffset + i * sizeof(WModelCacheMaterial), sizeof(entry));
+        if (!inside(entry.diffuseOffset, entry.diffuseLength) || !inside(entry.embeddedOffset, entry.embeddedLength)) {
+            return false;
+        }
+        materials.push_back(WMaterialData{
+            .diffuse = std::string((const char *)blob.data() + entry.diffuseOffset, entry.diffuseLength),
+            .embedded = blob.subspan(entry.embeddedOffset, entry.embeddedLength),
+            .embeddedWidth = entry.embeddedWidth,
+            .embeddedHeight = entry.embeddedHeight,
+        });
+    }
+
+    return true;
+}
+
+WModelCacheKey WModelCache::KeyFor(const WMappedFile &source, uint32_t importFlags, uint32_t optimizeFlags) {
+    return WModelCacheKey{
+        .sourceHash = Hash(source.span()),
+        .sourceSize = source.size(),
+        .importFlags = importFlags,
+        .optimizeFlags = optimizeFlags,
+    };
+}
+std::optional<WModelData> WModelCache::Load(const std::string &path, const WModelCacheKey &key) {
+    WMappedFile file = WMappedFile::Open(path);
+    if (!file.isOpen() || file.size() < sizeof(WModelCacheHeader)) {
+        return std::nullopt;
+    }
+
+    WModelCacheHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != MAGIC ||
+        header.version != VERSION ||
+        header.vertexStride != sizeof(WModelVertex) ||
+        header.importFlags != key.importFlags ||
+        header.optimizeFlags != key.optimizeFlags ||
+        header.sourceHash != key.sourceHash ||
+        header.sourceSize != key.sourceSize) {
+        return std::nullopt;
+    }
+
+    return WModelData::FromFile(std::move(file));
+}
+bool WModelCache::Store(const std::string &path, const std::vector<unsigned char> &bytes) {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write((const char *)bytes.data(), bytes.size());
+        if (!file.good()) {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+std::vector<unsigned char> WModelCache::Serialize(const WModelCacheKey &key,
+                                                  const std::vector<WImportedMesh> &meshes,
+                                                  const std::vector<WImportedMaterial> &materials,
+                                                  const WSkeleton *skeleton) {
+    WModelCacheHeader header{
+        .magic = MAGIC,
+        .version = VERSION,
+        .importFlags = key.importFlags,
+        .vertexStride = sizeof(WModelVertex),
+        .sourceHash = key.sourceHash,
+        .sourceSize = key.sourceSize,
+        .meshCount = (uint32_t)meshes.size(),
+        .materialCount = (uint32_t)materials.size(),
+        .optimizeFlags = key.optimizeFlags,
+    };
+
+    uint64_t offset = sizeof(WModelCacheHeader);
+    header.meshTableOffset = offset;
+    offset += meshes.size() * sizeof(WModelCacheMesh);
+    header.materialTableOffset = offset;
+    offset += materials.size() * sizeof(WModelCacheMaterial);
+
+    std::vector<WModelCacheMesh> meshTable;
+    meshTable.reserve(meshes.size());
+    for (const WImportedMesh &mesh : meshes) {
+        WModelCacheMesh entry{
+            .vertexCount = (uint32_t)mesh.vertices.size(),
+            .indexCount = (uint32_t)mesh.indices.size(),
+            .materialIndex = mesh.materialIndex,
+        };
+        offset = alignUp(offset, BLOB_ALIGNMENT);
+        entry.vertexOffset = offset;
+        offset += mesh.vertices.size() * sizeof(WModelVertex);
+        offset = alignUp(offset, BLOB_ALIGNMENT);
+        entry.indexOffset = offset;
+        offset += mesh.indices.size() * sizeof(uint32_t);
+        if (!mesh.skins.empty()) {
+            offset = alignUp(offset, BLOB_ALIGNMENT);
+            entry.skinOffset = offset;
+            entry.hasSkin = 1;
+            offset += mesh.skins.size() * sizeof(WModelSkin);
+        }
+        meshTable.push_back(entry);
+    }
+
+    std::vector<WModelCacheMaterial> materialTable;
+    materialTable.reserve(materials.size());
+    for (const WImportedMaterial &material : materials) {
+        WModelCacheMaterial entry{
+            .diffuseLength = (uint32_t)material.diffuse.size(),
+            .embeddedLength = (uint32_t)material.embedded.size(),
+            .embeddedWidth = material.embeddedWidth,
+            .embeddedHeight = material.embeddedHeight,
+        };
+        entry.diffuseOffset = offset;
+        offset += material.diffuse.size();
+        offset = alignUp(offset, BLOB_ALIGNMENT);
+        entry.embeddedOffset = offset;
+        offset += material.embedded.size();
+        materialTable.push_back(entry);
+    }
+
+    std::vector<unsigned char> skeletonBytes;
+    if (skeleton != nullptr) {
+        skeletonBytes = skeleton->serialize();
+        offset = alignUp(offset, BLOB_ALIGNMENT);
+        header.skeletonOffset = offset;
+        header.skeletonSize = skeletonBytes.size();
+        offset += skeletonBytes.size();
+    }
+    header.fileSize = offset;
+
+    std::vector<unsigned char> bytes(offset, 0);
+    memcpy(bytes.data(), &header, sizeof(header));
+    memcpy(bytes.data() + header.meshTableOffset, meshTable.data(), meshTable.size() * sizeof(WModelCacheMesh));
+    memcpy(bytes.data() + header.materialTableOffset, materialTable.data(),
+           materialTable.size() * sizeof(WModelCacheMaterial));
+    for (size_t i = 0; i < meshes.size(); i++) {
+        memcpy(bytes.data() + meshTable[i].vertexOffset, meshes[i].vertices.data(),
+               meshes[i].vertices.size() * sizeof(WModelVertex));
+        memcpy(bytes.data() + meshTable[i].indexOffset, meshes[i].indices.data(),
+               meshes[i].indices.size() * sizeof(uint32_t));
+        if (meshTable[i].hasSkin) {
+            memcpy(bytes.data() + meshTable[i].skinOffset, meshes[i].skins.data(),
+                   meshes[i].skins.size() * sizeof(WModelSkin));
+        }
+    }
+    for (size_t i = 0; i < materials.size(); i++) {
+        memcpy(bytes.data() + materialTable[i].diffuseOffset, materials[i].diffuse.data(), materials[i].diffuse.size());
+        memcpy(bytes.data() + materialTable[i].embeddedOffset, materials[i].embedded.data(),
+               materials[i].embedded.size());
+    }
+    if (!skeletonBytes.empty()) {
+        memcpy(bytes.data() + header.skeletonOffset, skeletonBytes.data(), skeletonBytes.size());
+    }
+
+    return bytes;
+}
+uint64_t WModelCache::Hash(std::span<const unsigned char> bytes) {
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char byte : bytes) {
+        hash ^= byte;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
@@ -0,0 +1,81 @@
+#include <WPipelineCache.hpp>
+#include <WResource.hpp>
+
+#include <cstring>
+
+WHandleCache<WRenderPipeline> WPipelineCache::renderPipelines{};
+WHandleCache<WGPUSampler> WPipelineCache::samplers{};
+WHandleCache<WGPUBindGroupLayout> WPipelineCache::bindGroupLayouts{};
+WHandleCache<WGPUPipelineLayout> WPipelineCache::pipelineLayouts{};
+std::mutex WPipelineCache::shaderMutex{};
+std::map<std::pair<WGPUDevice, WGPUShaderModule>, std::set<std::string>> WPipelineCache::shaderPipelines{};
+
+WCacheKey &WCacheKey::add(const char *text) {
+    uint32_t length = text == nullptr ? UINT32_MAX : std::strlen(text);
+    add(length);
+    if (text != nullptr) {
+        bytes.append(text, length);
+    }
+    return *this;
+}
+
+WRenderPipeline WPipelineCache::GetOrCreate(WGPUDevice device,
+                                            const WCacheKey &key,
+                                            const std::function<WRenderPipeline()> &create,
+                                            std::initializer_list<WGPUShaderModule> shaders) {
+    WRenderPipeline pipeline = renderPipelines.getOrCreate(device, key, create);
+    std::lock_guard<std::mutex> lock{shaderMutex};
+    for (WGPUShaderModule shader : shaders) {
+        if (shader != nullptr) {
+            shaderPipelines[{device, shader}].insert(key.str());
+        }
+    }
+    return pipeline;
+}
+WGPUSampler WPipelineCache::GetOrCreateSampler(WGPUDevice device, const WCacheKey &key, const std::function<WGPUSampler()> &create) {
+    return samplers.getOrCreate(device, key, create);
+}
+WGPUBindGroupLayout WPipelineCache::GetOrCreateBindGroupLayout(WGPUDevice device,
+                                                               const WCacheKey &key,
+                                                               const std::function<WGPUBindGroupLayout()> &create) {
+    return bindGroupLayouts.getOrCreate(device, key, create);
+}
+WGPUPipelineLayout WPipelineCache::GetOrCreatePipelineLayout(WGPUDevice device,
+                                                             const WCacheKey &key,
+                                                             const std::function<WGPUPipelineLayout()> &create) {
+    return pipelineLayouts.getOrCreate(device, key, create);
+}
+void WPipelineCache::PrintStats() {
+    auto print = [](const char *name, const WCacheStats &stats) {
+        fmt::println("[WEngine]::[INFO]: {} cache: {} object(s), {} hit(s), {} miss(es)", name, stats.size, stats.hits, stats.misses);
+    };
+    print("Render pipeline", renderPipelines.getStats());
+    print("Pipeline layout", pipelineLayouts.getStats());
+    print("Bind group layout", bindGroupLayouts.getStats());
+    print("Sampler", samplers.getStats());
+}
+void WPipelineCache::EvictShader(WGPUDevice device, WGPUShaderModule shader) {
+    std::set<std::string> keys;
+    {
+        std::lock_guard<std::mutex> lock{shaderMutex};
+        auto found = shaderPipelines.find({device, shader});
+        if (found == shaderPipelines.end()) {
+            return;
+        }
+        keys = std::move(found->second);
+        shaderPipelines.erase(found);
+    }
+    for (const std::string &key : keys) {
+        renderPipelines.erase(device, key, [](const WRenderPipeline &pipeline) { WRelease((WGPURenderPipeline)pipeline); });
+    }
+}
+void WPipelineCache::Clear(WGPUDevice device) {
+    {
+        std::lock_guard<std::mutex> lock{shaderMutex};
+        std::erase_if(shaderPipelines, [device](const auto &entry) { return entry.first.first == device; });
+    }
+    renderPipelines.clear(device, [](const WRenderPipeline &pipeline) { WRelease((WGPURenderPipeline)pipeline); });
+    pipelineLayouts.clear(device, [](const WGPUPipelineLayout &layout) { WRelease(layout); });
+    bindGroupLayouts.clear(device, [](const WGPUBindGroupLayout &layout) { WRelease(layout); });
+    samplers.clear(device, [](const WGPUSampler &sampler) { WRelease(sampler); });
+}
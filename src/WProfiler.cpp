@@ -0,0 +1,90 @@
+#include <WProfiler.hpp>
+
+#include <chrono>
+#include <fstream>
+
+std::atomic<WProfiler::ThreadBuffer *> WProfiler::threads{nullptr};
+std::atomic<uint32_t> WProfiler::threadCount{0};
+
+namespace {
+std::string escapeJson(const char *text) {
+    std::string escaped;
+    for (const char *c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(*c);
+    }
+    return escaped;
+}
+}  // namespace
+
+uint64_t WProfiler::Now() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+void WProfiler::Record(const char *name, uint64_t start, uint64_t end) {
+    ThreadBuffer &buffer = LocalBuffer();
+    Chunk *chunk = buffer.tail;
+    uint32_t count = chunk->count.load(std::memory_order_relaxed);
+    if (count == CHUNK_SIZE) {
+        Chunk *next = new Chunk();
+        chunk->next.store(next, std::memory_order_release);
+        buffer.tail = next;
+        chunk = next;
+        count = 0;
+    }
+    chunk->events[count] = WProfileEvent{name, start, end};
+    chunk->count.store(count + 1, std::memory_order_release);
+}
+void WProfiler::SetThreadName(const char *name) {
+    LocalBuffer().name.store(name, std::memory_order_release);
+}
+bool WProfiler::WriteChromeTrace(const std::string &path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        fmt::println("[WEngine]::[ERROR]: Failed to open trace file: '{}'", path);
+        return false;
+    }
+
+    uint64_t eventCount = 0;
+    bool first = true;
+    file << "{\"traceEvents\":[";
+    for (ThreadBuffer *buffer = threads.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+        const char *name = buffer->name.load(std::memory_order_acquire);
+        if (name != nullptr) {
+            file << (first ? "" : ",")
+                 << fmt::format("\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                                buffer->id, escapeJson(name));
+            first = false;
+        }
+        for (const Chunk *chunk = &buffer->head; chunk != nullptr; chunk = chunk->next.load(std::memory_order_acquire)) {
+            uint32_t count = chunk->count.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < count; i++) {
+                const WProfileEvent &event = chunk->events[i];
+                file << (first ? "" : ",")
+                     << fmt::format("\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                                    escapeJson(event.name), buffer->id, event.start / 1000.0,
+                                    (event.end - event.start) / 1000.0);
+                first = false;
+            }
+            eventCount += count;
+        }
+    }
+    file << "\n]}\n";
+
+    fmt::println("[WEngine]::[INFO]: Wrote {} profile events to '{}'", eventCount, path);
+    return true;
+}
+WProfiler::ThreadBuffer &WProfiler::LocalBuffer() {
+    thread_local ThreadBuffer *local = nullptr;
+    if (local == nullptr) {
+        local = new ThreadBuffer();
+        local->id = threadCount.fetch_add(1);
+        ThreadBuffer *head = threads.load(std::memory_order_relaxed);
+        do {
+            local->next = head;
+        } while (!threads.compare_exchange_weak(head, local, std::memory_order_release, std::memory_order_relaxed));
+    }
+    return *local;
+}
@@ -0,0 +1,90 @@
+#include <WResource.hpp>
+#include <WMemoryTracker.hpp>
+
+void WRelease(WGPUBuffer buffer) {
+    WMemoryTracker::Untrack(buffer);
+    wgpuBufferRelease(buffer);
+}
+void WRelease(WGPUTexture texture) {
+    WMemoryTracker::Untrack(texture);
+    wgpuTextureRelease(texture);
+}
+void WRelease(const WTexture &texture) {
+    wgpuTextureViewRelease(texture);
+    WRelease((WGPUTexture)texture);
+}
+void WRelease(const WUniformBuffer &buffer) {
+    WRelease((WGPUBuffer)buffer);
+}
+void WRelease(const WRenderBuffer &renderBuffer) {
+    WRelease(renderBuffer.getVertexBuffer());
+    WRelease(renderBuffer.getIndexBuffer());
+}
+void WRelease(const WBindGroup &bindGroup) {
+    wgpuBindGroupRelease(bindGroup);
+}
+void WRelease(const WRenderBundle &bundle) {
+    wgpuRenderBundleRelease(bundle);
+}
+
+void WDestroy(WGPUBuffer buffer) {
+    wgpuBufferDestroy(buffer);
+    WRelease(buffer);
+}
+void WDestroy(WGPUTexture texture) {
+    wgpuTextureDestroy(texture);
+    WRelease(texture);
+}
+void WDestroy(const WTexture &texture) {
+    wgpuTextureViewRelease(texture);
+    WDestroy((WGPUTexture)texture);
+}
+void WDestroy(const WUniformBuffer &buffer) {
+    WDestroy((WGPUBuffer)buffer);
+}
+
+WDeletionQueue WDeletionQueue::New(WGPUQueue queue) {
+    WDeletionQueue deletionQueue;
+    deletionQueue.queue = queue;
+    return deletionQueue;
+}
+void WDeletionQueue::retire(std::function<void()> destroy) {
+    retired.push_back(std::move(destroy));
+    pendingCount++;
+}
+void WDeletionQueue::submit() {
+    if (retired.empty()) {
+        return;
+    }
+
+    batches.push_back(std::make_unique<Batch>());
+    Batch *batch = batches.back().get();
+    batch->destroys = std::move(retired);
+    retired.clear();
+    wgpuQueueOnSubmittedWorkDone(
+        queue,
+        [](WGPUQueueWorkDoneStatus status, void *userdata) {
+            ((Batch *)userdata)->done = true;
+        },
+        batch);
+}
+uint32_t WDeletionQueue::collect() {
+    uint32_t destroyed = 0;
+    while (!batches.empty() && batches.front()->done) {
+        for (const std::function<void()> &destroy : batches.front()->destroys) {
+            destroy();
+        }
+        destroyed += batches.front()->destroys.size();
+        batches.pop_front();
+    }
+    pendingCount -= destroyed;
+    return destroyed;
+}
+void WDeletionQueue::flush(WGPUDevice device) {
+    submit();
+    wgpuDevicePoll(device, true, nullptr);
+    for (std::unique_ptr<Batch> &batch : batches) {
+        batch->done = true;
+    }
+    collect();
+}
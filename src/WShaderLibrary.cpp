@@ -0,0 +1,267 @@
+#include <WShaderLibrary.hpp>
+#include <WProfiler.hpp>
+
+#include <chrono>
+#include <filesystem>
+
+#ifdef WENGINE_PLATFORM_LINUX
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+WShaderLibrary::WShaderLibrary(WGPUDevice device, std::string directory)
+    : device(device), directory(std::move(directory)) {
+    watcher = std::thread([this]() { watch(); });
+}
+WShaderLibrary::~WShaderLibrary() {
+    stopping = true;
+    watcher.join();
+    for (const auto &[key, entry] : entries) {
+        release(entry.module);
+    }
+}
+WGPUShaderModule WShaderLibrary::load(const std::string &path, const WShaderPermutation &permutation) {
+    std::string key = Key(path, permutation);
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto found = entries.find(key);
+        if (found != entries.end()) {
+            stats.hits++;
+            return found->second.module;
+        }
+    }
+
+    WShaderSource source = WShaderPreprocessor::Process(path, permutation);
+    WGPUShaderModule module = Compile(device, key, source.code);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    stats.misses++;
+    stats.size = entries.size() + 1;
+    entries[key] = Entry{
+        .path = path,
+        .permutation = permutation,
+        .files = std::move(source.files),
+        .module = module,
+        .hash = Hash(source.code),
+    };
+    return module;
+}
+void WShaderLibrary::subscribe(const std::string &path, const WShaderPermutation &permutation, WShaderReload reload) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto found = entries.find(Key(path, permutation));
+    if (found == entries.end()) {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Shader '{}' must be loaded before subscribing to it", path).c_str());
+    }
+    found->second.subscribers.push_back(std::move(reload));
+}
+uint32_t WShaderLibrary::update() {
+    std::deque<Reload> ready;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        ready.swap(reloads);
+    }
+
+    uint32_t reloaded = 0;
+    for (const Reload &reload : ready) {
+        std::vector<WShaderReload> subscribers;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            subscribers = entries[reload.key].subscribers;
+        }
+
+        struct ScopeResult {
+            WGPUErrorType type = WGPUErrorType_NoError;
+            std::string message;
+        } result;
+        wgpuDevicePushErrorScope(device, WGPUErrorFilter_Validation);
+        WGPUShaderModule module = Compile(device, reload.key, reload.code);
+        std::vector<std::function<void()>> commits;
+        for (const WShaderReload &subscriber : subscribers) {
+            commits.push_back(subscriber(module));
+        }
+        wgpuDevicePopErrorScope(
+            device,
+            [](WGPUErrorType type, const char *message, void *userdata) {
+                ScopeResult *result = (ScopeResult *)userdata;
+                result->type = type;
+                result->message = message == nullptr ? "" : message;
+            },
+            &result);
+
+        if (result.type != WGPUErrorType_NoError) {
+            fmt::println("[WEngine]::[ERROR]: Shader '{}' failed to reload, keeping the previous version: {}", reload.key,
+                         result.message);
+            release(module);
+            continue;
+        }
+
+        for (const std::function<void()> &commit : commits) {
+            commit();
+        }
+
+        WGPUShaderModule previous = nullptr;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            Entry &entry = entries[reload.key];
+            previous = entry.module;
+            entry.module = module;
+        }
+        if (previous != nullptr && previous != module) {
+            release(previous);
+        }
+        reloaded++;
+        fmt::println("[WEngine]::[INFO]: Reloaded shader '{}' and {} pipeline(s)", reload.key, commits.size());
+    }
+    return reloaded;
+}
+void WShaderLibrary::release(WGPUShaderModule module) {
+    WPipelineCache::EvictShader(device, module);
+    wgpuShaderModuleRelease(module);
+}
+WGPUShaderModule WShaderLibrary::Compile(WGPUDevice device, const std::string &label, const std::string &code) {
+    WGPUShaderModuleWGSLDescriptor wgslDescriptor{
+        .chain = WGPUChainedStruct{
+            .sType = WGPUSType_ShaderModuleWGSLDescriptor,
+        },
+        .code = code.c_str(),
+    };
+    WGPUShaderModuleDescriptor shaderDescriptor{
+        .nextInChain = (const WGPUChainedStruct *)&wgslDescriptor,
+        .label = label.c_str(),
+    };
+
+    return wgpuDeviceCreateShaderModule(device, &shaderDescriptor);
+}
+uint64_t WShaderLibrary::Hash(const std::string &code) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (unsigned char c : code) {
+        hash = (hash ^ c) * 0x100000001B3ull;
+    }
+    return hash;
+}
+void WShaderLibrary::watch() {
+    WPROFILE_THREAD("Shader Watcher");
+#ifdef WENGINE_PLATFORM_LINUX
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    std::map<int, std::string> directories;
+    if (fd >= 0) {
+        std::error_code error;
+        std::vector<fs::path> paths{directory};
+        for (const fs::directory_entry &entry : fs::recursive_directory_iterator(directory, error)) {
+            if (entry.is_directory()) {
+                paths.push_back(entry.path());
+            }
+        }
+        for (const fs::path &path : paths) {
+            int watch = inotify_add_watch(fd, path.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (watch >= 0) {
+                directories[watch] = path.string();
+            }
+        }
+    }
+    if (!directories.empty()) {
+        alignas(inotify_event) char buffer[4096];
+        while (!stopping) {
+            pollfd descriptor{.fd = fd, .events = POLLIN};
+            if (poll(&descriptor, 1, 200) <= 0) {
+                continue;
+            }
+
+            std::set<std::string> changed;
+            ssize_t length = 0;
+            while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+                for (char *cursor = buffer; cursor < buffer + length;) {
+                    const inotify_event *event = (const inotify_event *)cursor;
+                    auto found = directories.find(event->wd);
+                    if (event->len > 0 && found != directories.end()) {
+                        changed.insert(Key((fs::path(found->second) / event->name).string()));
+                    }
+                    cursor += sizeof(inotify_event) + event->len;
+                }
+            }
+            for (const std::string &file : changed) {
+                reload(file);
+            }
+        }
+        close(fd);
+        return;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    fmt::println("[WEngine]::[WARN]: inotify is unavailable for '{}', polling shader files instead", directory);
+#endif
+
+    std::map<std::string, fs::file_time_type> writeTimes;
+    while (!stopping) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+        for (const std::string &file : watchedFiles()) {
+            std::error_code error;
+            fs::file_time_type writeTime = fs::last_write_time(file, error);
+            if (error) {
+                continue;
+            }
+            auto [found, inserted] = writeTimes.try_emplace(file, writeTime);
+            if (!inserted && found->second != writeTime) {
+                found->second = writeTime;
+                reload(file);
+            }
+        }
+    }
+}
+void WShaderLibrary::reload(const std::string &file) {
+    struct Pending {
+        std::string key;
+        std::string path;
+        WShaderPermutation permutation;
+        uint64_t hash;
+    };
+    std::vector<Pending> pending;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (const auto &[key, entry] : entries) {
+            if (entry.files.contains(file)) {
+                pending.push_back(Pending{key, entry.path, entry.permutation, entry.hash});
+            }
+        }
+    }
+
+    for (const Pending &shader : pending) {
+        WShaderSource source;
+        try {
+            source = WShaderPreprocessor::Process(shader.path, shader.permutation);
+        } catch (const std::exception &e) {
+            fmt::println("{}", e.what());
+            continue;
+        }
+        uint64_t hash = Hash(source.code);
+        if (hash == shader.hash) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock{mutex};
+        Entry &entry = entries[shader.key];
+        entry.hash = hash;
+        entry.files = std::move(source.files);
+        reloads.push_back(Reload{shader.key, std::move(source.code)});
+    }
+}
+std::set<std::string> WShaderLibrary::watchedFiles() {
+    std::lock_guard<std::mutex> lock{mutex};
+    std::set<std::string> files;
+    for (const auto &[key, entry] : entries) {
+        files.insert(entry.files.begin(), entry.files.end());
+    }
+    return files;
+}
+std::string WShaderLibrary::Key(const std::string &path) {
+    return fs::path(path).lexically_normal().generic_string();
+}
+std::string WShaderLibrary::Key(const std::string &path, const WShaderPermutation &permutation) {
+    std::string defines = permutation.key();
+    return defines.empty() ? Key(path) : fmt::format("{} [{}]", Key(path), defines);
+}
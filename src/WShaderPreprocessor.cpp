@@ -0,0 +1,164 @@
+#include <WShaderPreprocessor.hpp>
+#include <WProfiler.hpp>
+
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+WShaderPermutation &WShaderPermutation::define(const std::string &name, const std::string &value) {
+    defines[name] = value;
+    return *this;
+}
+WShaderPermutation &WShaderPermutation::setConstant(const std::string &name, double value) {
+    constants[name] = value;
+    return *this;
+}
+std::string WShaderPermutation::key() const {
+    std::string key;
+    for (const auto &[name, value] : defines) {
+        key += value.empty() ? fmt::format("{};", name) : fmt::format("{}={};", name, value);
+    }
+    for (const auto &[name, value] : constants) {
+        key += fmt::format("{}:{};", name, value);
+    }
+    return key;
+}
+
+WShaderSource WShaderPreprocessor::Process(const std::string &path, const WShaderPermutation &permutation) {
+    WPROFILE_FUNCTION();
+    State state{.defines = permutation.defines, .constants = permutation.constants};
+    ProcessFile(fs::path(path).lexically_normal().generic_string(), state);
+    for (const auto &[name, value] : permutation.constants) {
+        if (!state.baked.contains(name)) {
+            throw std::exception(
+                fmt::format("[WEngine]::[ERROR]: Shader constant '{}' matches no override declaration in '{}'", name, path).c_str());
+        }
+    }
+    return std::move(state.source);
+}
+void WShaderPreprocessor::ProcessFile(const std::string &path, State &state) {
+    if (!state.source.files.insert(path).second) {
+        return;
+    }
+
+    std::ifstream file{path};
+    if (!file.is_open()) {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Failed to open shader file from path: {}", path).c_str());
+    }
+
+    std::vector<Condition> conditions;
+    auto active = [&]() { return conditions.empty() || conditions.back().active; };
+
+    std::string line;
+    uint32_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] != '#') {
+            if (active()) {
+                state.source.code += BakeOverride(Substitute(line, state.defines), state.constants, state.baked);
+                state.source.code += '\n';
+            }
+            continue;
+        }
+
+        std::istringstream directive{line.substr(start + 1)};
+        std::string command, name;
+        directive >> command >> name;
+        std::string value;
+        std::getline(directive >> std::ws, value);
+        while (!value.empty() && std::isspace((unsigned char)value.back())) {
+            value.pop_back();
+        }
+
+        if (command == "ifdef" || command == "ifndef") {
+            bool defined = state.defines.contains(name);
+            conditions.push_back(Condition{
+                .active = active() && (command == "ifdef" ? defined : !defined),
+                .parentActive = active(),
+                .hasElse = false,
+            });
+        } else if (command == "else") {
+            if (conditions.empty() || conditions.back().hasElse) {
+                throw std::exception(fmt::format("[WEngine]::[ERROR]: Unexpected #else in '{}' at line {}", path, lineNumber).c_str());
+            }
+            Condition &condition = conditions.back();
+            condition.active = condition.parentActive && !condition.active;
+            condition.hasElse = true;
+        } else if (command == "endif") {
+            if (conditions.empty()) {
+                throw std::exception(fmt::format("[WEngine]::[ERROR]: Unexpected #endif in '{}' at line {}", path, lineNumber).c_str());
+            }
+            conditions.pop_back();
+        } else if (!active()) {
+            continue;
+        } else if (command == "define") {
+            state.defines[name] = value;
+        } else if (command == "undef") {
+            state.defines.erase(name);
+        } else if (command == "include") {
+            if (name.size() < 2 || name.front() != '"' || name.back() != '"') {
+                throw std::exception(fmt::format("[WEngine]::[ERROR]: Expected #include \"file\" in '{}' at line {}", path, lineNumber).c_str());
+            }
+            fs::path included = fs::path(path).parent_path() / name.substr(1, name.size() - 2);
+            ProcessFile(included.lexically_normal().generic_string(), state);
+        } else {
+            throw std::exception(fmt::format("[WEngine]::[ERROR]: Unknown directive '#{}' in '{}' at line {}", command, path, lineNumber).c_str());
+        }
+    }
+
+    if (!conditions.empty()) {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Missing #endif in '{}'", path).c_str());
+    }
+}
+std::string WShaderPreprocessor::Substitute(const std::string &line, const std::map<std::string, std::string> &defines) {
+    std::string result;
+    result.reserve(line.size());
+    for (size_t i = 0; i < line.size();) {
+        if (line.compare(i, 2, "//") == 0) {
+            result.append(line, i);
+            break;
+        }
+        if (!std::isalpha((unsigned char)line[i]) && line[i] != '_') {
+            result.push_back(line[i++]);
+            continue;
+        }
+
+        size_t end = i;
+        while (end < line.size() && (std::isalnum((unsigned char)line[end]) || line[end] == '_')) {
+            end++;
+        }
+        std::string identifier = line.substr(i, end - i);
+        auto found = defines.find(identifier);
+        result += found != defines.end() && !found->second.empty() ? found->second : identifier;
+        i = end;
+    }
+    return result;
+}
+std::string WShaderPreprocessor::BakeOverride(const std::string &line,
+                                              const std::map<std::string, double> &constants,
+                                              std::set<std::string> &baked) {
+    static const std::regex declaration{R"(^(\s*)override\s+(\w+)\s*(?::\s*(\w+)\s*)?(?:=[^;]*)?;(.*)$)"};
+    std::smatch match;
+    if (constants.empty() || !std::regex_match(line, match, declaration)) {
+        return line;
+    }
+    auto found = constants.find(match[2].str());
+    if (found == constants.end()) {
+        return line;
+    }
+
+    baked.insert(found->first);
+    std::string type = match[3].str();
+    double value = found->second;
+    std::string literal = type == "bool"  ? (value != 0.0 ? "true" : "false")
+                          : type == "u32" ? fmt::format("{}u", (uint64_t)value)
+                          : type == "i32" ? fmt::format("{}i", (int64_t)value)
+                                          : fmt::format("{}", value);
+    return fmt::format("{}const {}{} = {};{}", match[1].str(), match[2].str(), type.empty() ? "" : ": " + type, literal,
+                       match[4].str());
+}
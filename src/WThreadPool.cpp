@@ -0,0 +1,91 @@
+#include <WThreadPool.hpp>
+#include <WProfiler.hpp>
+
+#include <atomic>
+#include <exception>
+
+WThreadPool::WThreadPool(uint32_t threadCount) {
+    workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        workers.emplace_back([this]() { work(); });
+    }
+}
+WThreadPool::~WThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    condition.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+void WThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &function) {
+    if (count == 0) {
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto run = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            try {
+                function(i);
+            } catch (...) {
+                next.store(count);
+                throw;
+            }
+        }
+    };
+
+    size_t helperCount = std::min<size_t>(workers.size(), count - 1);
+    std::vector<std::future<void>> helpers;
+    helpers.reserve(helperCount);
+    for (size_t i = 0; i < helperCount; i++) {
+        helpers.push_back(submit(run));
+    }
+
+    std::exception_ptr error = nullptr;
+    try {
+        run();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (std::future<void> &helper : helpers) {
+        try {
+            helper.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+uint32_t WThreadPool::HardwareThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+void WThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        tasks.push_back(std::move(task));
+    }
+    condition.notify_one();
+}
+void WThreadPool::work() {
+    WPROFILE_THREAD("Worker");
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
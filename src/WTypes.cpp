@@ -1,17 +1,61 @@
 #include <WTypes.hpp>
 
 #include <WUtils.hpp>
+#include <WProfiler.hpp>
+#include <WMemoryTracker.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#include <ktx.h>
+
+#include <algorithm>
+
+static WGPUTextureFormat formatFromVkFormat(uint32_t vkFormat) {
+    switch (vkFormat) {
+        case 37:   // VK_FORMAT_R8G8B8A8_UNORM
+        case 43:   // VK_FORMAT_R8G8B8A8_SRGB
+            return WGPUTextureFormat_RGBA8Unorm;
+        case 133:  // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+        case 134:  // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+            return WGPUTextureFormat_BC1RGBAUnorm;
+        case 137:  // VK_FORMAT_BC3_UNORM_BLOCK
+        case 138:  // VK_FORMAT_BC3_SRGB_BLOCK
+            return WGPUTextureFormat_BC3RGBAUnorm;
+        case 145:  // VK_FORMAT_BC7_UNORM_BLOCK
+        case 146:  // VK_FORMAT_BC7_SRGB_BLOCK
+            return WGPUTextureFormat_BC7RGBAUnorm;
+        default:
+            return WGPUTextureFormat_Undefined;
+    }
+}
+static uint32_t formatBlockSize(WGPUTextureFormat format) {
+    return format >= WGPUTextureFormat_BC1RGBAUnorm && format <= WGPUTextureFormat_BC7RGBAUnormSrgb ? 4 : 1;
+}
+static uint32_t formatBlockBytes(WGPUTextureFormat format) {
+    switch (format) {
+        case WGPUTextureFormat_BC1RGBAUnorm:
+        case WGPUTextureFormat_BC1RGBAUnormSrgb:
+        case WGPUTextureFormat_BC4RUnorm:
+        case WGPUTextureFormat_BC4RSnorm:
+            return 8;
+        case WGPUTextureFormat_RGBA8Unorm:
+        case WGPUTextureFormat_RGBA8UnormSrgb:
+            return 4;
+        default:
+            return 16;
+    }
+}
 
 WGPUBuffer wgpuDeviceCreateBufferInit(WGPUDevice device, WGPUBufferDescriptor desc, const void *data) {
     if (desc.size == 0 || data == nullptr) {
-        return wgpuDeviceCreateBuffer(device, &desc);
+        WGPUBuffer buffer = wgpuDeviceCreateBuffer(device, &desc);
+        WMemoryTracker::TrackBuffer(buffer, desc);
+        return buffer;
     }
 
     desc.mappedAtCreation = true;
     WGPUBuffer buffer = wgpuDeviceCreateBuffer(device, &desc);
+    WMemoryTracker::TrackBuffer(buffer, desc);
 
     void *bufferData = wgpuBufferGetMappedRange(buffer, 0, desc.size);
     memcpy(bufferData, data, desc.size);
@@ -97,8 +141,109 @@ WTexture WTexture::GetDepthTexture(WGPUDevice device, uint32_t width, uint32_t h
         .setTextureUsages(WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_TextureBinding)
         .build(device, WGPUExtent3D{.width = width, .height = height, .depthOrArrayLayers = 1});
 }
+WTexture WTexture::fromImage(WGPUDevice device, const WImage &image, uint32_t baseLevel) {
+    WPROFILE_FUNCTION();
+    WGPUExtent3D size{
+        .width = image.getLevels()[baseLevel].width,
+        .height = image.getLevels()[baseLevel].height,
+        .depthOrArrayLayers = 1,
+    };
+
+    if (image.getFormat() == WGPUTextureFormat_RGBA8Unorm && image.getLevels().size() == 1) {
+        return WTextureBuilder::New()
+            .setFormat(WGPUTextureFormat_RGBA8Unorm)
+            .setGenerateMipmaps(true)
+            .build(device, size, 4, image.getPixels().data(), 4 * sizeof(stbi_uc));
+    }
+
+    WTexture texture = WTextureBuilder::New()
+                           .setFormat(image.getFormat())
+                           .setMipLevelCount(image.getLevels().size() - baseLevel)
+                           .build(device, size);
+
+    uint32_t blockSize = formatBlockSize(image.getFormat());
+    uint32_t blockBytes = formatBlockBytes(image.getFormat());
+    WGPUQueue queue = wgpuDeviceGetQueue(device);
+    for (uint32_t i = baseLevel; i < image.getLevels().size(); i++) {
+        const WImage::Level &level = image.getLevels()[i];
+        uint32_t blocksWide = (level.width + blockSize - 1) / blockSize;
+        uint32_t blocksHigh = (level.height + blockSize - 1) / blockSize;
+
+        WGPUImageCopyTexture destination{
+            .texture = texture,
+            .mipLevel = i - baseLevel,
+            .origin = WGPUOrigin3D{0, 0, 0},
+            .aspect = WGPUTextureAspect_All,
+        };
+        WGPUTextureDataLayout dataLayout{
+            .offset = 0,
+            .bytesPerRow = blocksWide * blockBytes,
+            .rowsPerImage = blocksHigh,
+        };
+        WGPUExtent3D levelSize{
+            .width = blocksWide * blockSize,
+            .height = blocksHigh * blockSize,
+            .depthOrArrayLayers = 1,
+        };
+        wgpuQueueWriteTexture(queue, &destination, image.getPixels().data() + level.offset, level.size, &dataLayout, &levelSize);
+    }
+    wgpuQueueRelease(queue);
+
+    return texture;
+}
 WTexture WTexture::fromFileAsRgba8(WGPUDevice device, std::string path, bool flipUV) {
-    stbi_set_flip_vertically_on_load(flipUV);
+    return fromImage(device, WImage::fromFileAsRgba8(path, flipUV));
+}
+WTexture WTexture::fromMemoryAsRgba8(WGPUDevice device, const void *data, size_t size, bool flipUV) {
+    return fromImage(device, WImage::fromMemoryAsRgba8(data, size, flipUV));
+}
+
+void WImage::generateMipmaps() {
+    WPROFILE_FUNCTION();
+    if (format != WGPUTextureFormat_RGBA8Unorm || levels.size() != 1) {
+        return;
+    }
+
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        Level source = levels.back();
+        Level level{
+            .width = std::max(1u, source.width / 2),
+            .height = std::max(1u, source.height / 2),
+            .offset = pixels.size(),
+        };
+        level.size = (size_t)level.width * level.height * 4;
+        pixels.resize(pixels.size() + level.size);
+
+        for (uint32_t y = 0; y < level.height; y++) {
+            uint32_t y0 = std::min(y * 2, source.height - 1);
+            uint32_t y1 = std::min(y * 2 + 1, source.height - 1);
+            for (uint32_t x = 0; x < level.width; x++) {
+                uint32_t x0 = std::min(x * 2, source.width - 1);
+                uint32_t x1 = std::min(x * 2 + 1, source.width - 1);
+                for (uint32_t c = 0; c < 4; c++) {
+                    auto texel = [&](uint32_t sx, uint32_t sy) {
+                        return (uint32_t)pixels[source.offset + ((size_t)sy * source.width + sx) * 4 + c];
+                    };
+                    pixels[level.offset + ((size_t)y * level.width + x) * 4 + c] =
+                        (unsigned char)((texel(x0, y0) + texel(x1, y0) + texel(x0, y1) + texel(x1, y1) + 2) / 4);
+                }
+            }
+        }
+        levels.push_back(level);
+    }
+}
+uint32_t WImage::getMaxBaseLevel() const {
+    uint32_t blockSize = formatBlockSize(format);
+    uint32_t level = 0;
+    while (level + 1 < levels.size() && levels[level + 1].width % blockSize == 0 && levels[level + 1].height % blockSize == 0) {
+        level++;
+    }
+    return level;
+}
+
+WImage WImage::fromFileAsRgba8(std::string path, bool flipUV) {
+    WPROFILE_FUNCTION();
+    stbi_set_flip_vertically_on_load_thread(flipUV);
 
     int32_t width, height, channels;
     stbi_uc *data = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
@@ -107,43 +252,86 @@ WTexture WTexture::fromFileAsRgba8(WGPUDevice device, std::string path, bool fli
         throw std::exception(fmt::format("[WEngine]::[ERROR]: Failed to load texture from path: '{}'", path).c_str());
     }
 
-    WGPUExtent3D size{
-        .width = (uint32_t)width,
-        .height = (uint32_t)height,
-        .depthOrArrayLayers = 1,
-    };
-
-    if (flipUV) {
-        stbi_set_flip_vertically_on_load(!flipUV);
-    }
-
-    return WTextureBuilder::New()
-        .setFormat(WGPUTextureFormat_RGBA8Unorm)
-        .build(device, size, 4, data, 4 * sizeof(stbi_uc));
-}
-WTexture WTexture::fromMemoryAsRgba8(WGPUDevice device, const void *data, size_t size, bool flipUV) {
-    stbi_set_flip_vertically_on_load(flipUV);
+    WImage image;
+    image.width = width;
+    image.height = height;
+    image.pixels.assign(data, data + (size_t)width * height * STBI_rgb_alpha);
+    image.levels.push_back(WImage::Level{image.width, image.height, 0, image.pixels.size()});
+    stbi_image_free(data);
+    return image;
+}
+WImage WImage::fromMemoryAsRgba8(const void *data, size_t size, bool flipUV) {
+    WPROFILE_FUNCTION();
+    stbi_set_flip_vertically_on_load_thread(flipUV);
 
     int32_t width, height, channels;
     stbi_uc *stbData = stbi_load_from_memory((const stbi_uc *)data, size, &width, &height, &channels, STBI_rgb_alpha);
 
-    if (data == nullptr) {
+    if (stbData == nullptr) {
         throw std::exception(fmt::format("[WEngine]::[ERROR]: Failed to load texture from memory!").c_str());
     }
 
-    WGPUExtent3D extent{
-        .width = (uint32_t)width,
-        .height = (uint32_t)height,
-        .depthOrArrayLayers = 1,
-    };
+    WImage image;
+    image.width = width;
+    image.height = height;
+    image.pixels.assign(stbData, stbData + (size_t)width * height * STBI_rgb_alpha);
+    image.levels.push_back(WImage::Level{image.width, image.height, 0, image.pixels.size()});
+    stbi_image_free(stbData);
+    return image;
+}
+WImage WImage::fromRgba8(const void *pixels, uint32_t width, uint32_t height) {
+    WImage image;
+    image.width = width;
+    image.height = height;
+    image.pixels.assign((const unsigned char *)pixels, (const unsigned char *)pixels + (size_t)width * height * 4);
+    image.levels.push_back(WImage::Level{image.width, image.height, 0, image.pixels.size()});
+    return image;
+}
+WImage WImage::fromKtx2File(std::string path, bool allowBC) {
+    WPROFILE_FUNCTION();
+    ktxTexture2 *ktx = nullptr;
+    KTX_error_code result = ktxTexture2_CreateFromNamedFile(path.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &ktx);
+    if (result != KTX_SUCCESS) {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Failed to load KTX2 texture from path: '{}' ({})", path, ktxErrorString(result)).c_str());
+    }
+    if (ktx->numDimensions != 2 || ktx->numLayers != 1 || ktx->numFaces != 1) {
+        ktxTexture_Destroy(ktxTexture(ktx));
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Only single-layer 2D KTX2 textures are supported: '{}'", path).c_str());
+    }
 
-    if (flipUV) {
-        stbi_set_flip_vertically_on_load(!flipUV);
+    if (ktxTexture2_NeedsTranscoding(ktx)) {
+        bool blockAligned = ktx->baseWidth % 4 == 0 && ktx->baseHeight % 4 == 0;
+        result = ktxTexture2_TranscodeBasis(ktx, allowBC && blockAligned ? KTX_TTF_BC7_RGBA : KTX_TTF_RGBA32, 0);
+        if (result != KTX_SUCCESS) {
+            ktxTexture_Destroy(ktxTexture(ktx));
+            throw std::exception(fmt::format("[WEngine]::[ERROR]: Failed to transcode KTX2 texture: '{}' ({})", path, ktxErrorString(result)).c_str());
+        }
     }
 
-    return WTextureBuilder::New()
-        .setFormat(WGPUTextureFormat_RGBA8Unorm)
-        .build(device, extent, 4, stbData, 4 * sizeof(stbi_uc));
+    WGPUTextureFormat format = formatFromVkFormat(ktx->vkFormat);
+    if (format == WGPUTextureFormat_Undefined || (!allowBC && formatBlockSize(format) > 1)) {
+        ktxTexture_Destroy(ktxTexture(ktx));
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Unsupported KTX2 texture format {} in: '{}'", ktx->vkFormat, path).c_str());
+    }
+
+    WImage image;
+    image.width = ktx->baseWidth;
+    image.height = ktx->baseHeight;
+    image.format = format;
+    const unsigned char *data = ktxTexture_GetData(ktxTexture(ktx));
+    image.pixels.assign(data, data + ktxTexture_GetDataSize(ktxTexture(ktx)));
+    for (uint32_t level = 0; level < ktx->numLevels; level++) {
+        ktx_size_t offset = 0;
+        ktxTexture_GetImageOffset(ktxTexture(ktx), level, 0, 0, &offset);
+        image.levels.push_back(WImage::Level{
+            .width = std::max(1u, ktx->baseWidth >> level),
+            .height = std::max(1u, ktx->baseHeight >> level),
+            .offset = offset,
+            .size = ktxTexture_GetImageSize(ktxTexture(ktx), level),
+        });
+    }
+    ktxTexture_Destroy(ktxTexture(ktx));
+    return image;
 }
 
 WUniformBuffer WUniformBuffer::New(WGPUDevice device, void *data, size_t size) {
@@ -162,24 +350,27 @@ WUniformBuffer WUniformBuffer::New(WGPUDevice device, void *data, size_t size) {
 
     return uniform;
 }
-void WUniformBuffer::update(WGPUQueue queue, void *data) {
+void WUniformBuffer::update(WGPUQueue queue, void *data) const {
     wgpuQueueWriteBuffer(queue, buffer, 0, data, size);
 }
-void WUniformBuffer::updateWithOffset(WGPUQueue queue, void *data, uint32_t offset) {
+void WUniformBuffer::updateWithOffset(WGPUQueue queue, void *data, uint32_t offset) const {
     wgpuQueueWriteBuffer(queue, buffer, offset, data, size);
 }
 
-WBindGroup WBindGroup::New(WGPUBindGroup bindGroup, WGPUBindGroupLayout bindGroupLayout) {
+WBindGroup WBindGroup::New(WGPUBindGroup bindGroup,
+                           WGPUBindGroupLayout bindGroupLayout,
+                           std::vector<uint32_t> dynamicOffsets) {
     WBindGroup wBindGroup;
     wBindGroup.bindGroup = bindGroup;
     wBindGroup.bindGroupLayout = bindGroupLayout;
+    wBindGroup.dynamicOffsets = dynamicOffsets;
     return wBindGroup;
 }
 void WBindGroup::bind(WGPURenderPassEncoder encoder, uint32_t groupIndex) {
-    wgpuRenderPassEncoderSetBindGroup(encoder, groupIndex, bindGroup, 0, nullptr);
+    wgpuRenderPassEncoderSetBindGroup(encoder, groupIndex, bindGroup, dynamicOffsets.size(), dynamicOffsets.data());
 }
 void WBindGroup::bind(WGPURenderBundleEncoder encoder, uint32_t groupIndex) {
-    wgpuRenderBundleEncoderSetBindGroup(encoder, groupIndex, bindGroup, 0, nullptr);
+    wgpuRenderBundleEncoderSetBindGroup(encoder, groupIndex, bindGroup, dynamicOffsets.size(), dynamicOffsets.data());
 }
 
 WVertexLayout WVertexLayout::New(size_t arrayStride) {
@@ -209,12 +400,19 @@ WVertexLayout &WVertexLayout::addAttribute(WGPUVertexFormat format, size_t offse
     return *this;
 }
 
-WRenderBuffer WRenderBuffer::New(WGPUDevice device, const void *vertices, size_t verticesSize, size_t verticesCount, const uint32_t *indices, size_t indicesCount) {
+WRenderBuffer WRenderBuffer::New(WGPUDevice device,
+                                 const void *vertices,
+                                 size_t verticesSize,
+                                 size_t verticesCount,
+                                 const void *indices,
+                                 size_t indicesCount,
+                                 WGPUIndexFormat indexFormat) {
     WRenderBuffer renderBuffer;
     renderBuffer.verticesCount = verticesCount;
     renderBuffer.verticesSize = verticesSize;
     renderBuffer.indicesCount = indicesCount;
-    renderBuffer.indicesSize = sizeof(uint32_t) * indicesCount;
+    renderBuffer.indicesSize = IndexSize(indexFormat) * indicesCount;
+    renderBuffer.indexFormat = indexFormat;
 
     renderBuffer.vertex = wgpuDeviceCreateBufferInit(
         device,
@@ -224,25 +422,60 @@ WRenderBuffer WRenderBuffer::New(WGPUDevice device, const void *vertices, size_t
         },
         vertices);
 
+    std::vector<unsigned char> padded;
+    if (renderBuffer.indicesSize % 4 != 0) {
+        padded.resize((renderBuffer.indicesSize + 3) / 4 * 4, 0);
+        memcpy(padded.data(), indices, renderBuffer.indicesSize);
+        indices = padded.data();
+    }
     renderBuffer.index = wgpuDeviceCreateBufferInit(
         device,
         WGPUBufferDescriptor{
             .usage = WGPUBufferUsage_Index,
-            .size = renderBuffer.indicesSize,
+            .size = (renderBuffer.indicesSize + 3) / 4 * 4,
         },
         indices);
 
     return renderBuffer;
 }
+WRenderBuffer WRenderBuffer::New(WGPUBuffer vertex,
+                                 WGPUBuffer index,
+                                 size_t verticesSize,
+                                 size_t verticesCount,
+                                 size_t indicesCount,
+                                 uint32_t baseVertex,
+                                 uint32_t firstIndex,
+                                 WGPUIndexFormat indexFormat) {
+    WRenderBuffer renderBuffer;
+    renderBuffer.vertex = vertex;
+    renderBuffer.index = index;
+    renderBuffer.verticesCount = verticesCount;
+    renderBuffer.verticesSize = verticesSize;
+    renderBuffer.indicesCount = indicesCount;
+    renderBuffer.indicesSize = IndexSize(indexFormat) * indicesCount;
+    renderBuffer.baseVertex = baseVertex;
+    renderBuffer.firstIndex = firstIndex;
+    renderBuffer.indexFormat = indexFormat;
+    return renderBuffer;
+}
+size_t WRenderBuffer::IndexSize(WGPUIndexFormat indexFormat) {
+    return indexFormat == WGPUIndexFormat_Uint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
 void WRenderBuffer::render(WGPURenderPassEncoder encoder) {
-    wgpuRenderPassEncoderSetVertexBuffer(encoder, 0, vertex, 0, verticesSize);
-    wgpuRenderPassEncoderSetIndexBuffer(encoder, index, WGPUIndexFormat_Uint32, 0, indicesSize);
-    wgpuRenderPassEncoderDrawIndexed(encoder, indicesCount, 1, 0, 0, 0);
+    wgpuRenderPassEncoderSetVertexBuffer(encoder, 0, vertex, 0, WGPU_WHOLE_SIZE);
+    wgpuRenderPassEncoderSetIndexBuffer(encoder, index, indexFormat, 0, WGPU_WHOLE_SIZE);
+    wgpuRenderPassEncoderDrawIndexed(encoder, indicesCount, 1, firstIndex, baseVertex, 0);
 }
 void WRenderBuffer::render(WGPURenderBundleEncoder encoder) {
-    wgpuRenderBundleEncoderSetVertexBuffer(encoder, 0, vertex, 0, verticesSize);
-    wgpuRenderBundleEncoderSetIndexBuffer(encoder, index, WGPUIndexFormat_Uint32, 0, indicesSize);
-    wgpuRenderBundleEncoderDrawIndexed(encoder, indicesCount, 1, 0, 0, 0);
+    bind(encoder);
+    draw(encoder);
+}
+void WRenderBuffer::bind(WGPURenderBundleEncoder encoder) {
+    wgpuRenderBundleEncoderSetVertexBuffer(encoder, 0, vertex, 0, WGPU_WHOLE_SIZE);
+    wgpuRenderBundleEncoderSetIndexBuffer(encoder, index, indexFormat, 0, WGPU_WHOLE_SIZE);
+}
+void WRenderBuffer::draw(WGPURenderBundleEncoder encoder, uint32_t instanceCount) {
+    wgpuRenderBundleEncoderDrawIndexed(encoder, indicesCount, instanceCount, firstIndex, baseVertex, 0);
 }
 
 WRenderPipeline WRenderPipeline::New(WGPURenderPipeline pipeline, WGPUPipelineLayout layout) {
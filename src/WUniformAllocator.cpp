@@ -0,0 +1,49 @@
+#include <WUniformAllocator.hpp>
+#include <WMemoryTracker.hpp>
+
+#include <cstring>
+#include <algorithm>
+
+WUniformAllocator WUniformAllocator::New(WGPUDevice device, uint32_t alignment, uint64_t capacity) {
+    WUniformAllocator allocator;
+    allocator.alignment = alignment;
+    allocator.shadow.resize(capacity);
+    allocator.freeList = WFreeList::New(capacity);
+
+    WGPUBufferDescriptor desc{
+        .label = "Uniform Allocator",
+        .usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst,
+        .size = capacity,
+    };
+    allocator.buffer = WOwned<WGPUBuffer>(wgpuDeviceCreateBuffer(device, &desc));
+    WMemoryTracker::TrackBuffer(allocator.buffer.get(), desc, "WUniformAllocator");
+    return allocator;
+}
+WUniformSlice WUniformAllocator::allocate(uint32_t size) {
+    uint32_t aligned = (size + alignment - 1) / alignment * alignment;
+    std::optional<uint64_t> offset = freeList.allocate(aligned, alignment);
+    if (!offset) {
+        throw std::exception(fmt::format("[WEngine]::[ERROR]: Uniform allocator is full ({} of {} bytes used)!",
+                                         freeList.getUsed(), freeList.getCapacity())
+                                 .c_str());
+    }
+    return WUniformSlice{.offset = (uint32_t)*offset, .size = size};
+}
+void WUniformAllocator::free(WUniformSlice slice) {
+    freeList.free(slice.offset, (slice.size + alignment - 1) / alignment * alignment);
+}
+void WUniformAllocator::write(WUniformSlice slice, const void *data) {
+    memcpy(shadow.data() + slice.offset, data, slice.size);
+    dirtyBegin = std::min<uint64_t>(dirtyBegin, slice.offset);
+    dirtyEnd = std::max<uint64_t>(dirtyEnd, slice.offset + slice.size);
+}
+void WUniformAllocator::upload(WGPUQueue queue) {
+    if (dirtyBegin >= dirtyEnd) {
+        return;
+    }
+    uint64_t begin = dirtyBegin / 4 * 4;
+    uint64_t end = std::min<uint64_t>((dirtyEnd + 3) / 4 * 4, shadow.size());
+    wgpuQueueWriteBuffer(queue, buffer.get(), begin, shadow.data() + begin, end - begin);
+    dirtyBegin = UINT64_MAX;
+    dirtyEnd = 0;
+}
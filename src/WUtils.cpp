@@ -1,4 +1,9 @@
 #include <WUtils.hpp>
+#include <WMipmapGenerator.hpp>
+#include <WProfiler.hpp>
+#include <WMemoryTracker.hpp>
+
+#include <limits>
 
 WRenderPassBuilder &WRenderPassBuilder::addColorTarget(WColorAttachment attachment) {
     colorAttachments.push_back(attachment);
@@ -10,11 +15,16 @@ WRenderPassBuilder &WRenderPassBuilder::setDepthAttachment(WDepthStencilAttachme
     depthTest = true;
     return *this;
 }
+WRenderPassBuilder &WRenderPassBuilder::setTimestampWrites(const WGPURenderPassTimestampWrites *timestampWrites) {
+    this->timestampWrites = timestampWrites;
+    return *this;
+}
 WGPURenderPassEncoder WRenderPassBuilder::build(WGPUCommandEncoder commandEncoder, const char *label) {
     WGPURenderPassDescriptor desc{
         .label = label,
         .colorAttachmentCount = colorAttachments.size(),
         .colorAttachments = colorAttachments.data(),
+        .timestampWrites = timestampWrites,
     };
 
     if (!depthTest) {
@@ -61,13 +71,22 @@ WTextureBuilder &WTextureBuilder::setSampleCount(uint32_t count) {
     desc.sampleCount = count;
     return *this;
 }
+WTextureBuilder &WTextureBuilder::setGenerateMipmaps(bool generate) {
+    generateMipmaps = generate;
+    return *this;
+}
 WTexture WTextureBuilder::build(WGPUDevice device,
                                 WGPUExtent3D size,
                                 uint32_t channels,
                                 const unsigned char *data,
                                 uint32_t stride) {
     desc.size = size;
+    if (generateMipmaps) {
+        desc.mipLevelCount = WMipmapGenerator::MipLevelCount(size);
+        desc.usage |= WGPUTextureUsage_RenderAttachment;
+    }
     WGPUTexture texture = wgpuDeviceCreateTexture(device, &desc);
+    WMemoryTracker::TrackTexture(texture, desc);
 
     if (data) {
         WGPUImageCopyTexture destination{
@@ -90,6 +109,11 @@ WTexture WTextureBuilder::build(WGPUDevice device,
             stride * size.width * size.height * size.depthOrArrayLayers,
             &dataLayout,
             &size);
+        wgpuQueueRelease(queue);
+
+        if (generateMipmaps) {
+            WMipmapGenerator::Generate(device, texture, desc);
+        }
     }
 
     return WTexture::New(texture, desc);
@@ -147,7 +171,13 @@ WSamplerBuilder &WSamplerBuilder::setMaxAnisotropy(uint16_t max) {
     return *this;
 }
 WGPUSampler WSamplerBuilder::build(WGPUDevice device) {
-    return wgpuDeviceCreateSampler(device, &desc);
+    WCacheKey key{};
+    key.add(desc.addressModeU).add(desc.addressModeV).add(desc.addressModeW);
+    key.add(desc.magFilter).add(desc.minFilter).add(desc.mipmapFilter);
+    key.add(desc.lodMinClamp).add(desc.lodMaxClamp).add(desc.compare).add(desc.maxAnisotropy);
+    return WPipelineCache::GetOrCreateSampler(device, key, [&]() {
+        return wgpuDeviceCreateSampler(device, &desc);
+    });
 }
 
 WBindGroupLayoutBuilder &WBindGroupLayoutBuilder::addBindingSampler(uint32_t binding, WGPUShaderStageFlags visibility) {
@@ -174,23 +204,47 @@ WBindGroupLayoutBuilder &WBindGroupLayoutBuilder::addBindingTexture(uint32_t bin
     });
     return *this;
 }
-WBindGroupLayoutBuilder &WBindGroupLayoutBuilder::addBindingUniform(uint32_t binding, WGPUShaderStageFlags visibility) {
+WBindGroupLayoutBuilder &WBindGroupLayoutBuilder::addBindingUniform(uint32_t binding,
+                                                                    WGPUShaderStageFlags visibility,
+                                                                    bool hasDynamicOffset) {
     entries.push_back(WGPUBindGroupLayoutEntry{
         .binding = binding,
         .visibility = visibility,
         .buffer = WGPUBufferBindingLayout{
             .type = WGPUBufferBindingType_Uniform,
+            .hasDynamicOffset = hasDynamicOffset,
+        },
+    });
+    return *this;
+}
+WBindGroupLayoutBuilder &WBindGroupLayoutBuilder::addBindingStorage(uint32_t binding, WGPUShaderStageFlags visibility) {
+    entries.push_back(WGPUBindGroupLayoutEntry{
+        .binding = binding,
+        .visibility = visibility,
+        .buffer = WGPUBufferBindingLayout{
+            .type = WGPUBufferBindingType_ReadOnlyStorage,
             .hasDynamicOffset = false,
         },
     });
     return *this;
 }
 WGPUBindGroupLayout WBindGroupLayoutBuilder::build(WGPUDevice device) {
-    WGPUBindGroupLayoutDescriptor desc{
-        .entryCount = entries.size(),
-        .entries = entries.data(),
-    };
-    return wgpuDeviceCreateBindGroupLayout(device, &desc);
+    WCacheKey key{};
+    key.add((uint32_t)entries.size());
+    for (const WGPUBindGroupLayoutEntry &entry : entries) {
+        key.add(entry.binding).add(entry.visibility);
+        key.add(entry.buffer.type).add(entry.buffer.hasDynamicOffset).add(entry.buffer.minBindingSize);
+        key.add(entry.sampler.type);
+        key.add(entry.texture.sampleType).add(entry.texture.viewDimension).add(entry.texture.multisampled);
+        key.add(entry.storageTexture.access).add(entry.storageTexture.format).add(entry.storageTexture.viewDimension);
+    }
+    return WPipelineCache::GetOrCreateBindGroupLayout(device, key, [&]() {
+        WGPUBindGroupLayoutDescriptor desc{
+            .entryCount = entries.size(),
+            .entries = entries.data(),
+        };
+        return wgpuDeviceCreateBindGroupLayout(device, &desc);
+    });
 }
 
 WBindGroupBuilder &WBindGroupBuilder::addBindingSampler(uint32_t binding, WGPUSampler sampler, WGPUShaderStageFlags visibility) {
@@ -227,13 +281,32 @@ WBindGroupBuilder &WBindGroupBuilder::addBindingUniform(uint32_t binding, WUnifo
     layoutBuilder.addBindingUniform(binding, visibility);
     return *this;
 }
+WBindGroupBuilder &WBindGroupBuilder::addBindingUniformDynamic(uint32_t binding, WGPUBuffer buffer, size_t size, uint32_t dynamicOffset, WGPUShaderStageFlags visibility) {
+    entries.push_back(WGPUBindGroupEntry{
+        .binding = binding,
+        .buffer = buffer,
+        .size = size,
+    });
+    dynamicOffsets[binding] = dynamicOffset;
+    layoutBuilder.addBindingUniform(binding, visibility, true);
+    return *this;
+}
+WBindGroupBuilder &WBindGroupBuilder::addBindingStorage(uint32_t binding, WGPUBuffer buffer, size_t size, WGPUShaderStageFlags visibility) {
+    entries.push_back(WGPUBindGroupEntry{
+        .binding = binding,
+        .buffer = buffer,
+        .size = size,
+    });
+    layoutBuilder.addBindingStorage(binding, visibility);
+    return *this;
+}
 WBindGroup WBindGroupBuilder::build(WGPUDevice device) {
     WGPUBindGroupLayout layout = buildBindGroupLayout(device);
     WGPUBindGroup bindGroup = buildBindGroup(device, layout);
-    return WBindGroup::New(bindGroup, layout);
+    return WBindGroup::New(bindGroup, layout, getDynamicOffsets());
 }
 WBindGroup WBindGroupBuilder::buildWithLayout(WGPUDevice device, WGPUBindGroupLayout layout) {
-    return WBindGroup::New(buildBindGroup(device, layout), layout);
+    return WBindGroup::New(buildBindGroup(device, layout), layout, getDynamicOffsets());
 }
 WGPUBindGroup WBindGroupBuilder::buildBindGroup(WGPUDevice device, WGPUBindGroupLayout layout) {
     WGPUBindGroupDescriptor desc{
@@ -246,26 +319,54 @@ WGPUBindGroup WBindGroupBuilder::buildBindGroup(WGPUDevice device, WGPUBindGroup
 WGPUBindGroupLayout WBindGroupBuilder::buildBindGroupLayout(WGPUDevice device) {
     return layoutBuilder.build(device);
 }
+std::vector<uint32_t> WBindGroupBuilder::getDynamicOffsets() const {
+    std::vector<uint32_t> offsets;
+    for (const auto &[binding, offset] : dynamicOffsets) {
+        offsets.push_back(offset);
+    }
+    return offsets;
+}
 
-WRenderBufferBuilder &WRenderBufferBuilder::setIndices(const std::vector<uint32_t> &indices) {
+WRenderBufferBuilder &WRenderBufferBuilder::setIndices(std::span<const uint32_t> indices) {
     this->indices = indices.data();
     this->indicesCount = indices.size();
     return *this;
 }
+WRenderBufferBuilder &WRenderBufferBuilder::setAllowNarrowIndices(bool allow) {
+    this->allowNarrowIndices = allow;
+    return *this;
+}
 WRenderBuffer WRenderBufferBuilder::build(WGPUDevice device) {
+    if (allowNarrowIndices && CanNarrowIndices(verticesCount)) {
+        std::vector<uint16_t> narrow = NarrowIndices({indices, indicesCount});
+        return WRenderBuffer::New(device, vertices, verticesSize, verticesCount, narrow.data(), indicesCount, WGPUIndexFormat_Uint16);
+    }
     return WRenderBuffer::New(device, vertices, verticesSize, verticesCount, indices, indicesCount);
 }
+bool WRenderBufferBuilder::CanNarrowIndices(size_t verticesCount) {
+    return verticesCount <= std::numeric_limits<uint16_t>::max() + 1;
+}
+std::vector<uint16_t> WRenderBufferBuilder::NarrowIndices(std::span<const uint32_t> indices) {
+    return std::vector<uint16_t>(indices.begin(), indices.end());
+}
 
 WPipelineLayoutBuilder &WPipelineLayoutBuilder::addBindGroupLayout(WGPUBindGroupLayout layout) {
     bindGroupLayouts.push_back(layout);
     return *this;
 }
 WGPUPipelineLayout WPipelineLayoutBuilder::build(WGPUDevice device) {
-    WGPUPipelineLayoutDescriptor desc{
-        .bindGroupLayoutCount = bindGroupLayouts.size(),
-        .bindGroupLayouts = bindGroupLayouts.data(),
-    };
-    return wgpuDeviceCreatePipelineLayout(device, &desc);
+    WCacheKey key{};
+    key.add((uint32_t)bindGroupLayouts.size());
+    for (WGPUBindGroupLayout layout : bindGroupLayouts) {
+        key.add(layout);
+    }
+    return WPipelineCache::GetOrCreatePipelineLayout(device, key, [&]() {
+        WGPUPipelineLayoutDescriptor desc{
+            .bindGroupLayoutCount = bindGroupLayouts.size(),
+            .bindGroupLayouts = bindGroupLayouts.data(),
+        };
+        return wgpuDeviceCreatePipelineLayout(device, &desc);
+    });
 }
 
 WRenderPipelineBuilder &WRenderPipelineBuilder::addBindGroupLayout(WGPUBindGroupLayout layout) {
@@ -301,14 +402,20 @@ WRenderPipelineBuilder &WRenderPipelineBuilder::setDefaultDepthState(WDepthState
     return *this;
 }
 WRenderPipeline WRenderPipelineBuilder::build(WGPUDevice device) {
-    WGPUPipelineLayout layout = buildPipelineLayout(device);
-    WGPURenderPipeline pipeline = buildRenderPipeline(device, layout);
-    return WRenderPipeline::New(pipeline, layout);
+    return WPipelineCache::GetOrCreate(
+        device, cacheKey(),
+        [&]() {
+            WGPUPipelineLayout layout = buildPipelineLayout(device);
+            WGPURenderPipeline pipeline = buildRenderPipeline(device, layout);
+            return WRenderPipeline::New(pipeline, layout);
+        },
+        {desc.vertex.module, fragmentState.module});
 }
 WRenderPipeline WRenderPipelineBuilder::buildWithLayout(WGPUDevice device, WGPUPipelineLayout layout) {
     return WRenderPipeline();
 }
 WGPURenderPipeline WRenderPipelineBuilder::buildRenderPipeline(WGPUDevice device, WGPUPipelineLayout layout) {
+    WPROFILE_FUNCTION();
     std::vector<WGPUVertexBufferLayout> vertexBufferLayouts;
     vertexBufferLayouts.reserve(vertexLayouts.size());
     for (const WVertexLayout &layout : vertexLayouts) {
@@ -358,6 +465,34 @@ WGPURenderPipeline WRenderPipelineBuilder::buildRenderPipeline(WGPUDevice device
 WGPUPipelineLayout WRenderPipelineBuilder::buildPipelineLayout(WGPUDevice device) {
     return layoutBuilder.build(device);
 }
+WCacheKey WRenderPipelineBuilder::cacheKey() const {
+    WCacheKey key{};
+    key.add((uint32_t)layoutBuilder.getBindGroupLayouts().size());
+    for (WGPUBindGroupLayout layout : layoutBuilder.getBindGroupLayouts()) {
+        key.add(layout);
+    }
+
+    key.add(desc.vertex.module).add(desc.vertex.entryPoint);
+    key.add((uint32_t)vertexLayouts.size());
+    for (const WVertexLayout &layout : vertexLayouts) {
+        key.add(layout.arrayStride).add(layout.stepMode).add((uint32_t)layout.attributes.size());
+        for (const WGPUVertexAttribute &attribute : layout.attributes) {
+            key.add(attribute.format).add(attribute.offset).add(attribute.shaderLocation);
+        }
+    }
+
+    key.add(fragmentState.module).add(fragmentState.entryPoint);
+    key.add((uint32_t)colorTargetStates.size());
+    for (const WGPUColorTargetState &target : colorTargetStates) {
+        key.add(target.format).add(target.writeMask).add(target.blend != nullptr);
+    }
+
+    key.add(depthTest).add(stencilTest);
+    if (depthTest) {
+        key.add(depthStencilState.format).add(depthStencilState.depthCompare).add(depthStencilState.depthWriteEnabled);
+    }
+    return key;
+}
 
 WRenderBundleBuilder &WRenderBundleBuilder::setRenderBuffer(WRenderBuffer renderBuffer) {
     this->renderBuffer = renderBuffer;
@@ -379,7 +514,21 @@ WRenderBundleBuilder &WRenderBundleBuilder::setRenderPipeline(WRenderPipeline pi
     this->pipeline = pipeline;
     return *this;
 }
+WRenderBundleBuilder &WRenderBundleBuilder::addDraw(WRenderBuffer renderBuffer, WBindGroup bindGroup) {
+    this->draws.push_back(Draw{renderBuffer, bindGroup});
+    return *this;
+}
+WRenderBundleBuilder &WRenderBundleBuilder::clearDraws() {
+    this->draws.clear();
+    return *this;
+}
+WRenderBundleBuilder &WRenderBundleBuilder::setInstanceBuffer(WGPUBuffer buffer, uint32_t instanceCount) {
+    this->instanceBuffer = buffer;
+    this->instanceCount = instanceCount;
+    return *this;
+}
 WRenderBundle WRenderBundleBuilder::build(WGPUDevice device) {
+    WPROFILE_FUNCTION();
     WGPURenderBundleEncoderDescriptor encoderDesc{
         .colorFormatCount = colorFormats.size(),
         .colorFormats = colorFormats.data(),
@@ -391,8 +540,29 @@ WRenderBundle WRenderBundleBuilder::build(WGPUDevice device) {
     for (uint32_t i = 0; i < bindGroups.size(); i++) {
         bindGroups[i].bind(encoder, i);
     }
-    renderBuffer.render(encoder);
+    if (instanceBuffer) {
+        wgpuRenderBundleEncoderSetVertexBuffer(encoder, 1, instanceBuffer, 0, WGPU_WHOLE_SIZE);
+    }
+    if (draws.empty()) {
+        renderBuffer.render(encoder);
+    }
+    WGPUBuffer boundVertex = nullptr;
+    WGPUBuffer boundIndex = nullptr;
+    WGPUIndexFormat boundFormat = WGPUIndexFormat_Undefined;
+    for (Draw &draw : draws) {
+        if (draw.renderBuffer.getVertexBuffer() != boundVertex ||
+            draw.renderBuffer.getIndexBuffer() != boundIndex ||
+            draw.renderBuffer.getIndexFormat() != boundFormat) {
+            draw.renderBuffer.bind(encoder);
+            boundVertex = draw.renderBuffer.getVertexBuffer();
+            boundIndex = draw.renderBuffer.getIndexBuffer();
+            boundFormat = draw.renderBuffer.getIndexFormat();
+        }
+        draw.bindGroup.bind(encoder, bindGroups.size());
+        draw.renderBuffer.draw(encoder, instanceCount);
+    }
     WGPURenderBundle renderBundle = wgpuRenderBundleEncoderFinish(encoder, nullptr);
+    wgpuRenderBundleEncoderRelease(encoder);
 
     return WRenderBundle::New(renderBundle);
 }
@@ -1,9 +1,27 @@
 #include <iostream>
+#include <string_view>
+#include <cctype>
 
 #include <WEngine.hpp>
 
 int main(int argc, char **arv) {
-    WEngine::Initialize();
+    WEngineConfig config{};
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = arv[i];
+        if (arg == "--headless") {
+            config.headless = true;
+            config.maxFrames = i + 1 < argc && std::isdigit(arv[i + 1][0]) ? std::stoul(arv[++i]) : 600;
+        } else if (arg == "--fallback-adapter") {
+            config.forceFallbackAdapter = true;
+        }
+    }
+
+    try {
+        WEngine::Initialize(config);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
 
     WEngine &engine = WEngine::GetInstance();
 